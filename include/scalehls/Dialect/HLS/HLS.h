@@ -66,7 +66,8 @@ void setTiming(Operation *op, int64_t begin, int64_t end, int64_t latency,
 /// Resource attribute utils.
 ResourceAttr getResource(Operation *op);
 void setResource(Operation *op, ResourceAttr resource);
-void setResource(Operation *op, int64_t lut, int64_t dsp, int64_t bram);
+void setResource(Operation *op, int64_t lut, int64_t dsp, int64_t bram,
+                 int64_t ff = 0);
 
 /// Loop information attribute utils.
 LoopInfoAttr getLoopInfo(Operation *op);
@@ -86,6 +87,16 @@ void setParallelAttr(Operation *op);
 bool hasPointAttr(Operation *op);
 void setPointAttr(Operation *op);
 
+/// Unroll attribute utils of parallel loops.
+bool hasUnrollAttr(Operation *op);
+void setUnrollAttr(Operation *op);
+
+/// Profiled trip count and branch probability attribute utils.
+Optional<int64_t> getProfiledTripCount(Operation *op);
+void setProfiledTripCount(Operation *op, int64_t tripCount);
+Optional<double> getThenProbability(Operation *op);
+void setThenProbability(Operation *op, double probability);
+
 /// Function directives attribute utils.
 FuncDirectiveAttr getFuncDirective(Operation *op);
 void setFuncDirective(Operation *op, FuncDirectiveAttr FuncDirective);
@@ -172,6 +172,14 @@ void getArrays(Block &block, SmallVectorImpl<Value> &arrays,
 
 Optional<unsigned> getAverageTripCount(AffineForOp forOp);
 
+/// Get the overall trip count of an affine.parallel or scf.parallel loop if all
+/// its bounds are constant.
+Optional<int64_t> getParallelTripCount(Operation *op);
+
+/// Return whether the parallel loop is fully unrolled, which is true if it is
+/// marked with the unroll attribute or its trip count is small and constant.
+bool isUnrolledParallelLoop(Operation *op);
+
 bool checkDependence(Operation *A, Operation *B);
 
 func::FuncOp getTopFunc(ModuleOp module, std::string topFuncName = "");
@@ -24,16 +24,16 @@ public:
     return TypeSwitch<Operation *, ResultType>(op)
         .template Case<
             // HLS dialect operations.
-            BufferOp, ConstBufferOp, StreamOp, StreamReadOp, StreamWriteOp,
-            AxiBundleOp, AxiPortOp, AxiPackOp, PrimMulOp, PrimCastOp,
-            hls::AffineSelectOp,
+            ScheduleOp, NodeOp, BufferOp, ConstBufferOp, StreamOp,
+            StreamReadOp, StreamWriteOp, AxiBundleOp, AxiPortOp, AxiPackOp,
+            PrimMulOp, PrimCastOp, hls::AffineSelectOp,
 
             // Function operations.
             func::CallOp, func::ReturnOp,
 
             // SCF statements.
-            scf::ForOp, scf::IfOp, scf::ParallelOp, scf::ReduceOp,
-            scf::ReduceReturnOp, scf::YieldOp,
+            scf::ForOp, scf::WhileOp, scf::IfOp, scf::ParallelOp,
+            scf::ReduceOp, scf::ReduceReturnOp, scf::ConditionOp, scf::YieldOp,
 
             // Affine statements.
             AffineForOp, AffineIfOp, AffineParallelOp, AffineApplyOp,
@@ -96,6 +96,8 @@ public:
   }
 
   // HLS dialect operations.
+  HANDLE(ScheduleOp);
+  HANDLE(NodeOp);
   HANDLE(BufferOp);
   HANDLE(ConstBufferOp);
   HANDLE(StreamOp);
@@ -114,10 +116,12 @@ public:
 
   // SCF statements.
   HANDLE(scf::ForOp);
+  HANDLE(scf::WhileOp);
   HANDLE(scf::IfOp);
   HANDLE(scf::ParallelOp);
   HANDLE(scf::ReduceOp);
   HANDLE(scf::ReduceReturnOp);
+  HANDLE(scf::ConditionOp);
   HANDLE(scf::YieldOp);
 
   // Affine statements.
@@ -0,0 +1,31 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2020-2021 The ScaleHLS Authors.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SCALEHLS_PROFILE_PASSES_H
+#define SCALEHLS_PROFILE_PASSES_H
+
+#include "mlir/Pass/Pass.h"
+#include "scalehls/InitAllDialects.h"
+#include <memory>
+
+namespace mlir {
+namespace scalehls {
+
+/// The profiling passes execute the design on the host through the MLIR
+/// ExecutionEngine, thus are kept out of the transform library.
+void registerProfilePasses();
+
+std::unique_ptr<Pass>
+createProfileExecutionPass(std::string hlsTopFunc = "main",
+                           std::string profileInputDir = "");
+
+#define GEN_PASS_CLASSES
+#include "scalehls/Profile/Passes.h.inc"
+
+} // namespace scalehls
+} // namespace mlir
+
+#endif // SCALEHLS_PROFILE_PASSES_H
@@ -12,15 +12,199 @@
 #include "scalehls/Dialect/HLS/Visitor.h"
 #include "scalehls/Transforms/Utils.h"
 #include "llvm/Support/JSON.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace mlir {
 namespace scalehls {
 
-// Get the operator name to latency/DSP usage mapping.
+// Get the operator name to latency/DSP/LUT/FF usage mapping.
 void getLatencyMap(llvm::json::Object *config,
                    llvm::StringMap<int64_t> &latencyMap);
 void getDspUsageMap(llvm::json::Object *config,
                     llvm::StringMap<int64_t> &dspUsageMap);
+void getLutUsageMap(llvm::json::Object *config,
+                    llvm::StringMap<int64_t> &lutUsageMap);
+void getFfUsageMap(llvm::json::Object *config,
+                   llvm::StringMap<int64_t> &ffUsageMap);
+
+// Get the operator name to delay (in nanoseconds) mapping.
+void getDelayMap(llvm::json::Object *config,
+                 llvm::StringMap<double> &delayMap);
+
+// Get the AXI interface configurations, including the port width in bits, the
+// maximum burst length, the number of outstanding transactions, and the
+// latency of each transaction in cycles.
+void getAxiMap(llvm::json::Object *config, llvm::StringMap<int64_t> &axiMap);
+
+// Get the target clock period in nanoseconds excluding the clock uncertainty,
+// which is the time budget of chained operators.
+double getClockPeriod(llvm::json::Object *config);
+
+// Get the key of an integer operator in the latency/DSP usage mapping, where
+// the bit width is rounded up to 8, 16, 32, or 64.
+std::string getIntOperatorKey(StringRef name, unsigned bitWidth);
+
+//===----------------------------------------------------------------------===//
+// DependenceCache Class Declaration
+//===----------------------------------------------------------------------===//
+
+/// A cache of memref dependence results shared by all estimators in a run.
+/// Since affine maps and integer sets are uniqued in the context, the cache key
+/// is built from the canonicalized access maps, the bounds and conditions of
+/// all surrounding loops and ifs, and the loop depth. Therefore, the cached
+/// results can be reused across the cloned functions and loops in the DSE.
+/// This class is thread-safe.
+class DependenceCache {
+public:
+  /// Check the dependence of the two accesses at the given loop depth, where
+  /// dependence components are only computed if "depComps" is not nullptr.
+  DependenceResult
+  checkDependence(const MemRefAccess &srcAccess, const MemRefAccess &dstAccess,
+                  unsigned depth,
+                  SmallVectorImpl<DependenceComponent> *depComps = nullptr);
+
+  unsigned getNumQueries() const { return numQueries; }
+  unsigned getNumHits() const { return numHits; }
+
+private:
+  struct Entry {
+    DependenceResult::ResultEnum value;
+    bool hasComps;
+    SmallVector<std::pair<Optional<int64_t>, Optional<int64_t>>, 4> comps;
+  };
+
+  std::mutex mutex;
+  llvm::StringMap<Entry> entries;
+
+  std::atomic<unsigned> numQueries{0};
+  std::atomic<unsigned> numHits{0};
+};
+
+//===----------------------------------------------------------------------===//
+// Estimation Results
+//===----------------------------------------------------------------------===//
+
+/// The estimation results share the same accessors with TimingAttr,
+/// ResourceAttr, and LoopInfoAttr. They are held by the estimator rather than
+/// uniqued in the context, and are only materialized into attributes on demand.
+struct EstimatedTiming {
+  EstimatedTiming() = default;
+  explicit EstimatedTiming(int64_t begin, int64_t end, int64_t latency,
+                           int64_t interval)
+      : begin(begin), end(end), latency(latency), interval(interval),
+        valid(true) {}
+
+  explicit operator bool() const { return valid; }
+  int64_t getBegin() const { return begin; }
+  int64_t getEnd() const { return end; }
+  int64_t getLatency() const { return latency; }
+  int64_t getInterval() const { return interval; }
+
+  int64_t begin = 0;
+  int64_t end = 0;
+  int64_t latency = 0;
+  int64_t interval = 0;
+  bool valid = false;
+};
+
+struct EstimatedResource {
+  EstimatedResource() = default;
+  explicit EstimatedResource(int64_t lut, int64_t dsp, int64_t bram,
+                             int64_t ff)
+      : lut(lut), dsp(dsp), bram(bram), ff(ff), valid(true) {}
+
+  explicit operator bool() const { return valid; }
+  int64_t getLut() const { return lut; }
+  int64_t getDsp() const { return dsp; }
+  int64_t getBram() const { return bram; }
+  int64_t getFf() const { return ff; }
+
+  int64_t lut = 0;
+  int64_t dsp = 0;
+  int64_t bram = 0;
+  int64_t ff = 0;
+  bool valid = false;
+};
+
+struct EstimatedLoopInfo {
+  EstimatedLoopInfo() = default;
+  explicit EstimatedLoopInfo(int64_t flattenTripCount, int64_t iterLatency,
+                             int64_t minII)
+      : flattenTripCount(flattenTripCount), iterLatency(iterLatency),
+        minII(minII), valid(true) {}
+
+  explicit operator bool() const { return valid; }
+  int64_t getFlattenTripCount() const { return flattenTripCount; }
+  int64_t getIterLatency() const { return iterLatency; }
+  int64_t getMinII() const { return minII; }
+
+  int64_t flattenTripCount = 0;
+  int64_t iterLatency = 0;
+  int64_t minII = 0;
+  bool valid = false;
+};
+
+/// The limiting cause of the II of a pipelined loop or function, which is
+/// either the target II, the port pressure of a memref partition, a stream
+/// channel, or an AXI bundle, a loop-carried dependence, or the interval of a
+/// called sub-function.
+struct EstimatedIIBottleneck {
+  enum class Kind { None, Target, Resource, Stream, Axi, Dependence, Call };
+
+  explicit operator bool() const { return kind != Kind::None; }
+  StringRef getKindName() const {
+    switch (kind) {
+    case Kind::None:
+      return "none";
+    case Kind::Target:
+      return "target";
+    case Kind::Resource:
+      return "resource";
+    case Kind::Stream:
+      return "stream";
+    case Kind::Axi:
+      return "axi";
+    case Kind::Dependence:
+      return "dependence";
+    case Kind::Call:
+      return "call";
+    }
+    llvm_unreachable("unknown bottleneck kind");
+  }
+
+  Kind kind = Kind::None;
+  int64_t II = 0;
+
+  // An access to the memref, stream channel, or AXI bundle with the worst port
+  // pressure, the source access of the binding dependence, or the call to the
+  // sub-function with the largest interval.
+  Operation *srcOp = nullptr;
+  // The destination access of the binding dependence.
+  Operation *dstOp = nullptr;
+
+  // The memref partition with the worst port pressure.
+  int64_t partition = -1;
+  // The distance of the binding dependence.
+  int64_t distance = 0;
+};
+
+/// All estimation results of an operation.
+struct EstimatedResults {
+  EstimatedTiming timing;
+  EstimatedResource resource;
+  EstimatedLoopInfo loopInfo;
+  EstimatedIIBottleneck bottleneck;
+
+  // Partition indices and maximum multiplexer size of memory accesses.
+  SmallVector<int64_t, 4> partitionIndices;
+  int64_t maxMuxSize = 1;
+
+  // The accumulated delay from the inputs of the operation through all its
+  // chained successors in the same clock cycle.
+  double chainDelay = 0;
+};
 
 //===----------------------------------------------------------------------===//
 // ScaleHLSEstimator Class Declaration
@@ -29,16 +213,65 @@ void getDspUsageMap(llvm::json::Object *config,
 class ScaleHLSEstimator
     : public HLSVisitorBase<ScaleHLSEstimator, bool, int64_t> {
 public:
-  explicit ScaleHLSEstimator(llvm::StringMap<int64_t> &latencyMap,
-                             llvm::StringMap<int64_t> &dspUsageMap,
-                             bool depAnalysis)
+  explicit ScaleHLSEstimator(
+      llvm::StringMap<int64_t> &latencyMap,
+      llvm::StringMap<int64_t> &dspUsageMap,
+      llvm::StringMap<int64_t> &lutUsageMap,
+      llvm::StringMap<int64_t> &ffUsageMap, llvm::StringMap<int64_t> &axiMap,
+      llvm::StringMap<double> &delayMap, double clockPeriod, bool depAnalysis,
+      std::shared_ptr<DependenceCache> depCache = nullptr)
       : latencyMap(latencyMap), dspUsageMap(dspUsageMap),
+        lutUsageMap(lutUsageMap), ffUsageMap(ffUsageMap), axiMap(axiMap),
+        delayMap(delayMap), clockPeriod(clockPeriod),
+        depCache(depCache ? depCache : std::make_shared<DependenceCache>()),
         depAnalysis(depAnalysis) {}
 
+  /// Create a new estimator sharing the same target configurations and
+  /// dependence cache. This is required when multiple estimations are conducted
+  /// in parallel, because the scheduling information held by an estimator is
+  /// not thread-safe.
+  ScaleHLSEstimator clone() const {
+    auto estimator = ScaleHLSEstimator(latencyMap, dspUsageMap, lutUsageMap,
+                                       ffUsageMap, axiMap, delayMap,
+                                       clockPeriod, depAnalysis, depCache);
+    estimator.loopResources = loopResources;
+    return estimator;
+  }
+
+  /// Estimate the resource utilization of each loop as well, which is only
+  /// required by QoR reports and is disabled by default.
+  void setLoopResources(bool enable) { loopResources = enable; }
+
+  /// Return the dependence cache shared by this estimator and its clones.
+  DependenceCache &getDependenceCache() const { return *depCache; }
+
+  /// Return the number of times the results of subfunctions are looked up, and
+  /// the number of times they are reused from a previous estimation.
+  unsigned getNumCalleeQueries() const { return calleeResults->numQueries; }
+  unsigned getNumCalleeHits() const { return calleeResults->numHits; }
+
+  /// Return the number of times the schedules of outermost loops are looked up
+  /// by this estimator, and the number of times they are replayed from a
+  /// recorded schedule. Subfunctions are estimated by clones, thus not counted.
+  unsigned getNumLoopScheduleQueries() const { return numLoopScheduleQueries; }
+  unsigned getNumLoopScheduleHits() const { return numLoopScheduleHits; }
+
   // Entry for estimating function and loop.
   void estimateFunc(func::FuncOp func);
   void estimateLoop(AffineForOp loop, func::FuncOp func);
 
+  /// Materialize the estimation results of all estimated functions nested in
+  /// "root" into timing, resource, loop_info, partition_indices, and
+  /// max_mux_size attributes.
+  void materializeAttributes(Operation *root);
+
+  /// Accessors of the estimation results, which are valid until the next
+  /// estimation is started.
+  EstimatedTiming getTiming(Operation *op) const;
+  EstimatedResource getResource(Operation *op) const;
+  EstimatedLoopInfo getLoopInfo(Operation *op) const;
+  EstimatedIIBottleneck getIIBottleneck(Operation *op) const;
+
   using HLSVisitorBase::visitOp;
   bool visitUnhandledOp(Operation *op, int64_t begin) {
     // Default latency of any unhandled operation is 0.
@@ -46,9 +279,20 @@ public:
   }
 
   bool visitOp(AffineForOp op, int64_t begin);
+  bool visitOp(AffineParallelOp op, int64_t begin);
   bool visitOp(AffineIfOp op, int64_t begin);
+  bool visitOp(scf::ForOp op, int64_t begin);
+  bool visitOp(scf::WhileOp op, int64_t begin);
+  bool visitOp(scf::ParallelOp op, int64_t begin);
   bool visitOp(scf::IfOp op, int64_t begin);
   bool visitOp(func::CallOp op, int64_t begin);
+  bool visitOp(ScheduleOp op, int64_t begin);
+  bool visitOp(StreamReadOp op, int64_t begin) {
+    return setTiming(op, begin, begin + 1, 1, 1), true;
+  }
+  bool visitOp(StreamWriteOp op, int64_t begin) {
+    return setTiming(op, begin, begin + 1, 1, 1), true;
+  }
   bool visitOp(AffineLoadOp op, int64_t begin) {
     return estimateLoadStoreTiming(op, begin), true;
   }
@@ -69,12 +313,8 @@ public:
   /// Handle operations with profiled latency.
 #define HANDLE(OPTYPE, KEYNAME)                                                \
   bool visitOp(OPTYPE op, int64_t begin) {                                     \
-    auto latency = latencyMap[KEYNAME] + 1;                                    \
-    setTiming(op, begin, begin + latency, latency, 1);                         \
-    for (unsigned i = 0; i < latency; ++i)                                     \
-      ++numOperatorMap[begin + i][KEYNAME];                                    \
-    ++totalNumOperatorMap[KEYNAME];                                            \
-    return true;                                                               \
+    auto latency = latencyMap.lookup(KEYNAME) + 1;                             \
+    return estimateOperator(op, begin, KEYNAME, latency), true;                \
   }
   HANDLE(arith::AddFOp, "fadd");
   HANDLE(arith::SubFOp, "fadd");
@@ -84,48 +324,250 @@ public:
   HANDLE(math::ExpOp, "fexp");
 #undef HANDLE
 
+  /// Handle integer operations, whose latency and DSP usage are profiled for
+  /// each bit width.
+#define HANDLE(OPTYPE, KEYNAME)                                                \
+  bool visitOp(OPTYPE op, int64_t begin) {                                     \
+    return estimateIntOperator(op, begin, KEYNAME), true;                      \
+  }
+  HANDLE(arith::AddIOp, "add");
+  HANDLE(arith::SubIOp, "add");
+  HANDLE(arith::MulIOp, "mul");
+  HANDLE(arith::DivSIOp, "div");
+  HANDLE(arith::DivUIOp, "div");
+  HANDLE(arith::RemSIOp, "rem");
+  HANDLE(arith::RemUIOp, "rem");
+  HANDLE(arith::CmpIOp, "cmp");
+  HANDLE(arith::ShLIOp, "shift");
+  HANDLE(arith::ShRSIOp, "shift");
+  HANDLE(arith::ShRUIOp, "shift");
+  HANDLE(arith::AndIOp, "logic");
+  HANDLE(arith::OrIOp, "logic");
+  HANDLE(arith::XOrIOp, "logic");
+  HANDLE(arith::MaxSIOp, "minmax");
+  HANDLE(arith::MinSIOp, "minmax");
+  HANDLE(arith::MaxUIOp, "minmax");
+  HANDLE(arith::MinUIOp, "minmax");
+  HANDLE(arith::SelectOp, "select");
+  HANDLE(arith::TruncIOp, "cast");
+  HANDLE(arith::ExtUIOp, "cast");
+  HANDLE(arith::ExtSIOp, "cast");
+  HANDLE(arith::IndexCastOp, "cast");
+  HANDLE(PrimCastOp, "cast");
+#undef HANDLE
+
+  bool visitOp(PrimMulOp op, int64_t begin) {
+    // A packed multiplication computes two multiplications with one DSP.
+    auto isVector = op.getC().getType().isa<VectorType>();
+    auto num = isVector && !op.isPackMul() ? 2 : 1;
+    return estimateOperator(op, begin, "prim_mul",
+                            latencyMap.lookup("prim_mul"), num),
+           true;
+  }
+
 private:
+  void setTiming(Operation *op, int64_t begin, int64_t end, int64_t latency,
+                 int64_t interval) {
+    results[op].timing = EstimatedTiming(begin, end, latency, interval);
+  }
+  void setResource(Operation *op, EstimatedResource resource) {
+    results[op].resource = resource;
+  }
+  void setLoopInfo(Operation *op, int64_t flattenTripCount,
+                   int64_t iterLatency, int64_t minII) {
+    results[op].loopInfo =
+        EstimatedLoopInfo(flattenTripCount, iterLatency, minII);
+  }
+
+  /// Operator related methods.
+  void estimateOperator(Operation *op, int64_t begin, StringRef key,
+                        int64_t latency, int64_t num = 1);
+  void estimateIntOperator(Operation *op, int64_t begin, StringRef name);
+  double getSuccChainDelay(Operation *op, int64_t level) const;
+
   /// LoadOp and StoreOp related methods.
   void getPartitionIndices(Operation *op);
+  int64_t getMaxMuxSize(Operation *op) const;
   void estimateLoadStoreTiming(Operation *op, int64_t begin);
 
   /// AffineForOp related methods.
-  int64_t getResMinII(int64_t begin, int64_t end, MemAccessesMap &map);
-  int64_t getDepMinII(int64_t II, func::FuncOp func, MemAccessesMap &map);
-  int64_t getDepMinII(int64_t II, AffineForOp forOp, MemAccessesMap &map);
+  bool scheduleLoop(AffineForOp op, int64_t begin);
+  bool scheduleSeqLoop(Operation *op, ArrayRef<Block *> blocks,
+                       int64_t tripCount, int64_t begin);
+  bool scheduleParallelLoop(Operation *op, Block &body, int64_t tripCount,
+                            int64_t begin);
+  int64_t getResMinII(int64_t begin, int64_t end, MemAccessesMap &map,
+                      EstimatedIIBottleneck *bottleneck = nullptr);
+  int64_t getAxiMinII(AffineForOp loop, int64_t &burstLatency,
+                      EstimatedIIBottleneck *bottleneck = nullptr);
+  int64_t getCallMinII(Block &block,
+                       EstimatedIIBottleneck *bottleneck = nullptr);
+  int64_t getDepMinII(int64_t II, func::FuncOp func, MemAccessesMap &map,
+                      EstimatedIIBottleneck *bottleneck = nullptr);
+  int64_t getDepMinII(int64_t II, AffineForOp forOp, MemAccessesMap &map,
+                      EstimatedIIBottleneck *bottleneck = nullptr);
 
   /// Block scheduler and estimator.
-  ResourceAttr calculateResource(Operation *funcOrLoop);
-  TimingAttr estimateBlock(Block &block, int64_t begin = 0);
+  EstimatedResource calculateResource(Operation *funcOrLoop);
+  void calculateLoopResources(Operation *funcOrNode);
+  EstimatedTiming estimateBlock(Block &block, int64_t begin = 0);
   void reverseTiming(Block &block);
-  void initEstimator(Block &block);
+  void initEstimator();
+  void scheduleFunc(func::FuncOp func);
+  void scheduleNode(NodeOp node);
 
-  // Hold the memory ports information.
-  struct MemPortInfo {
-    unsigned rdPort = 0;
-    unsigned wrPort = 0;
-    unsigned rdwrPort = 0;
+  // Hold the results of operations nested in an operation (including the
+  // operation itself), indexed by their pre-order walk position, such that they
+  // can be replayed onto the operation if it is not changed.
+  struct RecordedResults {
+    std::vector<std::pair<unsigned, EstimatedResults>> results;
 
-    SmallVector<MemRefAccess, 2> rdAccesses;
+    // The accesses referred by the II bottlenecks of loops, which are indexed
+    // by the walk position of the loop and the accesses (-1 for nullptr).
+    std::vector<std::tuple<unsigned, int64_t, int64_t>> bottleneckOps;
   };
 
-  // For storing memory port information of all partitions indexed by the
-  // {schedule_level, memref}.
-  using MemPortInfos = std::vector<MemPortInfo>;
-  using MemPortInfosMap = DenseMap<int64_t, DenseMap<Value, MemPortInfos>>;
-  MemPortInfosMap memPortInfosMap;
+  void recordResults(RecordedResults &recorded, ArrayRef<Operation *> ops,
+                     int64_t begin);
+  void replayResults(const RecordedResults &recorded,
+                     ArrayRef<Operation *> ops, int64_t begin);
 
-  // For storing the number of each operator indexed by the schedule level.
+  // Hold the schedule of an outermost loop relative to its begin level. As the
+  // schedule of an outermost loop only depends on the loop itself, it can be
+  // replayed at any begin level if the loop is not changed.
+  struct LoopSchedule : public RecordedResults {
+    // The number of operators, operations, and the memory port reservations
+    // of each schedule level, where operations are indexed by their walk
+    // position.
+    std::vector<std::pair<int64_t, llvm::StringMap<int64_t>>> numOperators;
+    std::vector<std::pair<int64_t, llvm::StringMap<int64_t>>> numOperations;
+    std::vector<std::pair<unsigned, int64_t>> reservations;
+    llvm::StringMap<int64_t> totalNumOperators;
+  };
+
+  void recordLoopSchedule(LoopSchedule &schedule, ArrayRef<Operation *> ops,
+                          int64_t begin, unsigned logBegin);
+  // Replay the schedule at the begin level. Return false if any memory port
+  // reservation fails, in which case nothing is replayed.
+  bool replayLoopSchedule(const LoopSchedule &schedule,
+                          ArrayRef<Operation *> ops, int64_t begin);
+
+  // Hold the memory ports reservation table of a memref. Each schedule level
+  // is mapped to a row of a flat bitset, where each row is indexed by
+  // partition * numPorts + port. In each partition, read ports are placed
+  // first, followed by write ports and read-write ports.
+  struct MemPortTable {
+    explicit MemPortTable(MemRefType type);
+
+    /// Get the partitions touched by an access with the given partition
+    /// indices, where index -1 means all partitions of the dimension.
+    void getPartitions(ArrayRef<int64_t> partitionIndices,
+                       SmallVectorImpl<int64_t> &partitions) const;
+
+    /// Try to reserve a port of each partition at the given schedule level.
+    /// Return false if any partition has run out of ports.
+    bool reserve(int64_t level, const MemRefAccess &access,
+                 ArrayRef<int64_t> partitions);
+
+    /// Get the minimum II such that the ports reserved in the range of
+    /// [begin, end) can be folded modulo II without exceeding the available
+    /// ports of any partition. The partition requiring the largest II is
+    /// returned in "worstPartition" if it is not nullptr. The reservations are
+    /// counted "numReplicas" times for replicated loop bodies.
+    int64_t getResMinII(int64_t begin, int64_t end,
+                        int64_t *worstPartition = nullptr,
+                        int64_t numReplicas = 1) const;
+
+  private:
+    unsigned getRow(int64_t level);
+    int64_t findFreePort(unsigned row, int64_t partition, unsigned portBegin,
+                         unsigned portEnd) const;
+
+    SmallVector<int64_t, 8> factors;
+    int64_t numPartitions;
+    unsigned rdPorts = 0;
+    unsigned wrPorts = 0;
+    unsigned rdwrPorts = 0;
+    unsigned numPorts;
+    unsigned numWords;
+
+    DenseMap<int64_t, unsigned> rows;
+    std::vector<uint64_t> words;
+
+    // Hold the ports reserved by write operations, which are required to tell
+    // reads and writes placed on read/write ports apart.
+    std::vector<uint64_t> writeWords;
+
+    // Hold the scheduled read operations of each row, which are used to detect
+    // identical reads that can share the same ports.
+    std::vector<SmallVector<Operation *, 4>> rowReads;
+  };
+
+  // For storing the estimation results of each operation.
+  DenseMap<Operation *, EstimatedResults> results;
+
+  // Hold the results of a subfunction, which are reused across estimations as
+  // long as the structure key of the subfunction, including the keys of all
+  // functions called by it, is not changed. As functions are not modified
+  // during an estimation, the key is only checked once in each estimation.
+  struct CalleeResults : public RecordedResults {
+    std::vector<int64_t> key;
+    EstimatedTiming timing;
+    EstimatedResource resource;
+    unsigned epoch = 0;
+  };
+
+  // For storing the results of subfunctions keyed by their symbol names, which
+  // is shared with the estimators of subfunctions. The epoch is increased when
+  // a new estimation is started.
+  struct CalleeResultsCache {
+    llvm::StringMap<CalleeResults> entries;
+    unsigned epoch = 0;
+    unsigned numQueries = 0;
+    unsigned numHits = 0;
+  };
+  std::shared_ptr<CalleeResultsCache> calleeResults =
+      std::make_shared<CalleeResultsCache>();
+  void replayCalleeResults(func::FuncOp callee);
+
+  // For storing the schedules of outermost loops recorded in the current and
+  // the last estimation, keyed by the structure of the loops. Schedules that
+  // are not used by the current estimation are dropped in the next estimation.
+  llvm::StringMap<LoopSchedule> loopSchedules;
+  llvm::StringMap<LoopSchedule> lastLoopSchedules;
+  unsigned numLoopScheduleQueries = 0;
+  unsigned numLoopScheduleHits = 0;
+
+  // For storing the memory ports reservation table of each memref, and the
+  // log of all reservations in the order of being reserved.
+  DenseMap<Value, MemPortTable> memPortTables;
+  std::vector<std::pair<Operation *, int64_t>> reservationLog;
+
+  // For storing the number of each operator indexed by the schedule level, and
+  // the number of operations bound to the operators indexed by the level at
+  // which the operations are started.
   using NumOperatorMap = DenseMap<int64_t, llvm::StringMap<int64_t>>;
   NumOperatorMap numOperatorMap;
+  NumOperatorMap numOperationMap;
   llvm::StringMap<int64_t> totalNumOperatorMap;
 
-  // Store the operator name to latency/DSP usage mapping.
+  // Store the operator name to latency/DSP/LUT/FF usage mapping, the AXI
+  // interface configurations, and the operator name to delay mapping.
   llvm::StringMap<int64_t> &latencyMap;
   llvm::StringMap<int64_t> &dspUsageMap;
+  llvm::StringMap<int64_t> &lutUsageMap;
+  llvm::StringMap<int64_t> &ffUsageMap;
+  llvm::StringMap<int64_t> &axiMap;
+  llvm::StringMap<double> &delayMap;
+
+  // The time budget of chained operators in nanoseconds.
+  double clockPeriod;
+
+  // The dependence cache shared by this estimator and its clones.
+  std::shared_ptr<DependenceCache> depCache;
 
-  DominanceInfo DT;
   bool depAnalysis = true;
+  bool loopResources = false;
 };
 
 } // namespace scalehls
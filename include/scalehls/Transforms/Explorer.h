@@ -8,6 +8,7 @@
 #define SCALEHLS_TRANSFORMS_EXPLORER_H
 
 #include "scalehls/Transforms/Estimator.h"
+#include <random>
 
 namespace mlir {
 namespace scalehls {
@@ -20,15 +21,17 @@ using TileConfig = unsigned;
 
 struct LoopDesignPoint {
   explicit LoopDesignPoint(int64_t latency, int64_t dspNum,
-                           TileConfig tileConfig, unsigned targetII)
+                           TileConfig tileConfig, unsigned targetII,
+                           bool flatten = true)
       : latency(latency), dspNum(dspNum), tileConfig(tileConfig),
-        targetII(targetII) {}
+        targetII(targetII), flatten(flatten) {}
 
   int64_t latency;
   int64_t dspNum;
 
   TileConfig tileConfig;
   unsigned targetII;
+  bool flatten;
 
   bool isActive = true;
 };
@@ -38,7 +41,7 @@ public:
   explicit LoopDesignSpace(func::FuncOp func, AffineLoopBand &band,
                            ScaleHLSEstimator &estimator, unsigned maxDspNum,
                            unsigned maxExplParallel, unsigned maxLoopParallel,
-                           bool directiveOnly);
+                           bool directiveOnly, unsigned randomSeed = 0);
 
   /// Return the actual tile vector given a tile config.
   FactorList getTileList(TileConfig config);
@@ -52,6 +55,10 @@ public:
   /// Evaluate all design points under the given tile config.
   bool evaluateTileConfig(TileConfig config);
 
+  /// Evaluate all design points under the given tile config and flatten
+  /// directive of the loops that perfectly nest the pipelined loop.
+  bool evaluateTileConfig(TileConfig config, bool flatten);
+
   /// Initialize the design space.
   void initializeLoopDesignSpace(unsigned maxInitParallel);
 
@@ -91,8 +98,13 @@ public:
   /// Holds all tile configs that have not been estimated.
   llvm::SmallDenseSet<TileConfig, 32> unestimatedTileConfigs;
 
-  // Whether to include loop transformation into the loop design space.
+  // Whether to include loop transformation into the loop design space. If only
+  // directives are included, the loop flatten directive is explored as well.
   bool directiveOnly;
+
+  // The random engine of the neighbor search, which is seeded with the current
+  // time if the given seed is zero.
+  std::mt19937 randomEngine;
 };
 
 //===----------------------------------------------------------------------===//
@@ -141,7 +153,14 @@ public:
   void combLoopDesignSpaces();
 
   void dumpFuncDesignSpace(StringRef csvFilePath);
-  bool exportParetoDesigns(unsigned outputNum, StringRef outputRootPath);
+
+  /// Export the sampled pareto design points. Sampled points are processed in
+  /// parallel if multi-threading is enabled in the context. If "exportCpp" is
+  /// true, HLS C++ is emitted along with the MLIR of each design point.
+  bool exportParetoDesigns(unsigned outputNum, StringRef outputRootPath,
+                           bool exportCpp = false);
+  LogicalResult exportParetoDesign(unsigned paretoIndex,
+                                   StringRef outputRootPath, bool exportCpp);
 
   SmallVector<FuncDesignPoint, 16> paretoPoints;
 
@@ -161,17 +180,25 @@ public:
 class ScaleHLSExplorer {
 public:
   explicit ScaleHLSExplorer(ScaleHLSEstimator &estimator, unsigned outputNum,
-                            unsigned maxDspNum, unsigned maxInitParallel,
-                            unsigned maxExplParallel, unsigned maxLoopParallel,
-                            unsigned maxIterNum, float maxDistance)
-      : estimator(estimator), outputNum(outputNum), maxDspNum(maxDspNum),
+                            bool exportCpp, unsigned maxDspNum,
+                            unsigned maxLutNum, unsigned maxFfNum,
+                            unsigned maxInitParallel, unsigned maxExplParallel,
+                            unsigned maxLoopParallel, unsigned maxIterNum,
+                            float maxDistance, unsigned randomSeed = 0)
+      : estimator(estimator), outputNum(outputNum), exportCpp(exportCpp),
+        maxDspNum(maxDspNum), maxLutNum(maxLutNum), maxFfNum(maxFfNum),
         maxInitParallel(maxInitParallel), maxExplParallel(maxExplParallel),
         maxLoopParallel(maxLoopParallel), maxIterNum(maxIterNum),
-        maxDistance(maxDistance) {}
+        maxDistance(maxDistance), randomSeed(randomSeed) {}
 
   bool emitQoRDebugInfo(func::FuncOp func, std::string message);
 
+  /// Return whether the estimated resource utilization of the function meets
+  /// the DSP, LUT, and FF constraints.
+  bool meetResourceConstr(func::FuncOp func);
+
   bool evaluateFuncPipeline(func::FuncOp func);
+  bool exploreFuncDirectives(func::FuncOp func);
   bool simplifyLoopNests(func::FuncOp func);
   bool optimizeLoopBands(func::FuncOp func, bool directiveOnly);
   bool exploreDesignSpace(func::FuncOp func, bool directiveOnly,
@@ -185,7 +212,13 @@ public:
   // The number of pareto designs that will be generated.
   unsigned outputNum;
 
+  // Whether to emit HLS C++ for the generated pareto designs.
+  bool exportCpp;
+
+  // The resource constraints of the function.
   unsigned maxDspNum;
+  unsigned maxLutNum;
+  unsigned maxFfNum;
 
   // The maximum parallelism of the initiation and exploration of phase of DSE.
   unsigned maxInitParallel;
@@ -199,6 +232,10 @@ public:
 
   // The maximum distance in the neighbor search of DSE.
   float maxDistance;
+
+  // The random seed of the neighbor search of DSE, where zero indicates a seed
+  // derived from the current time.
+  unsigned randomSeed;
 };
 
 } // namespace scalehls
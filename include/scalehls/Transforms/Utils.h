@@ -34,9 +34,10 @@ bool applyLoopTiling(AffineLoopBand &band, FactorList tileList,
                      bool loopNormalize = true, bool annotatePointLoop = true);
 
 /// Apply loop pipelining to the pipelineLoc of the input loop band, all inner
-/// loops are automatically fully unrolled.
+/// loops are automatically fully unrolled. If "flatten" is true, all outer
+/// loops that perfectly nest the pipelined loop are flattened.
 bool applyLoopPipelining(AffineLoopBand &band, unsigned pipelineLoc,
-                         unsigned targetII);
+                         unsigned targetII, bool flatten = true);
 
 /// Apply unroll and jam to the loop band with the given overall unroll factor.
 bool applyLoopUnrollJam(AffineLoopBand &band, unsigned unrollFactor);
@@ -58,18 +59,30 @@ bool applyAutoArrayPartition(func::FuncOp func);
 
 bool applyFuncPreprocess(func::FuncOp func, bool topFunc);
 
+/// Inline the callee into the call site and erase the call. The callee is
+/// erased as well if it has no other uses.
+bool applyCalleeInlining(func::CallOp call);
+
 /// Apply memory optimizations.
 bool applyMemoryOpts(func::FuncOp func);
 
+/// Load the dialects depended on by the memory optimizations, which must be
+/// called before applying memory optimizations from multiple threads, as
+/// dialects can't be loaded during multi-threaded execution.
+void loadMemoryOptsDialects(MLIRContext *context);
+
 /// Apply optimization strategy to a loop band. The ancestor function is also
 /// passed in because the post-tiling optimizations have to take function as
 /// target, e.g. canonicalizer and array partition.
 bool applyOptStrategy(AffineLoopBand &band, func::FuncOp func,
-                      FactorList tileList, unsigned targetII);
+                      FactorList tileList, unsigned targetII,
+                      bool flatten = true);
 
-/// Apply optimization strategy to a function.
+/// Apply optimization strategy to a function. If "flattens" is empty, all loop
+/// bands are flattened.
 bool applyOptStrategy(func::FuncOp func, ArrayRef<FactorList> tileLists,
-                      ArrayRef<unsigned> targetIIs);
+                      ArrayRef<unsigned> targetIIs,
+                      ArrayRef<bool> flattens = {});
 
 } // namespace scalehls
 } // namespace mlir
@@ -14,14 +14,23 @@
 #include "mlir/Dialect/Affine/Analysis/LoopAnalysis.h"
 #include "scalehls-c/EmitHLSCpp.h"
 #include "scalehls-c/HLS.h"
+#include "scalehls/Transforms/Estimator.h"
+#include "scalehls/Transforms/Explorer.h"
 #include "scalehls/Transforms/Utils.h"
 
 #include "llvm-c/ErrorHandling.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Signals.h"
 
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstddef>
 #include <numpy/arrayobject.h>
 #include <pybind11/pybind11.h>
+#include <type_traits>
 
 namespace py = pybind11;
 
@@ -142,45 +151,181 @@ static void getVectorFromUnsignedNpArray(PyObject *object,
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Numpy array view utils
+//===----------------------------------------------------------------------===//
+
+static_assert(sizeof(unsigned) == 4 && sizeof(bool) == 1,
+              "unexpected size of design point fields");
+
+/// The scalar fields of FuncDesignPoint, which is not standard-layout as it
+/// holds the loop design points, thus is copied into this record.
+struct FuncDesignPointRecord {
+  int64_t latency;
+  int64_t dspNum;
+};
+
+static_assert(std::is_standard_layout_v<LoopDesignPoint> &&
+                  std::is_standard_layout_v<FuncDesignPointRecord>,
+              "offsetof requires standard-layout design points");
+
+/// Return the structured numpy data type of LoopDesignPoint, whose fields are
+/// laid out as in the C++ struct.
+static PyArray_Descr *getLoopDesignPointDescr() {
+  _import_array();
+  py::dict spec;
+  spec["names"] = py::make_tuple("latency", "dsp", "tile_config", "target_ii",
+                                 "flatten");
+  spec["formats"] = py::make_tuple("i8", "i8", "u4", "u4", "?");
+  spec["offsets"] = py::make_tuple(
+      offsetof(LoopDesignPoint, latency), offsetof(LoopDesignPoint, dspNum),
+      offsetof(LoopDesignPoint, tileConfig),
+      offsetof(LoopDesignPoint, targetII), offsetof(LoopDesignPoint, flatten));
+  spec["itemsize"] = sizeof(LoopDesignPoint);
+
+  PyArray_Descr *descr = nullptr;
+  if (!PyArray_DescrConverter(spec.ptr(), &descr))
+    throw py::error_already_set();
+  return descr;
+}
+
+/// Return the structured numpy data type of FuncDesignPointRecord, where the
+/// loop design points are not included.
+static PyArray_Descr *getFuncDesignPointDescr() {
+  _import_array();
+  py::dict spec;
+  spec["names"] = py::make_tuple("latency", "dsp");
+  spec["formats"] = py::make_tuple("i8", "i8");
+  spec["offsets"] = py::make_tuple(offsetof(FuncDesignPointRecord, latency),
+                                   offsetof(FuncDesignPointRecord, dspNum));
+  spec["itemsize"] = sizeof(FuncDesignPointRecord);
+
+  PyArray_Descr *descr = nullptr;
+  if (!PyArray_DescrConverter(spec.ptr(), &descr))
+    throw py::error_already_set();
+  return descr;
+}
+
+/// Return a read-only numpy array viewing "size" elements of type "descr" at
+/// "data" without copying. The view holds a reference to "owner", which must
+/// own the viewed buffer.
+static py::object getNpArrayView(PyArray_Descr *descr, void *data, size_t size,
+                                 py::handle owner) {
+  _import_array();
+  npy_intp dims[] = {(npy_intp)size};
+  auto object = PyArray_NewFromDescr(
+      &PyArray_Type, descr, 1, dims, /*strides=*/nullptr, data,
+      NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_ALIGNED, /*obj=*/nullptr);
+  if (!object)
+    throw py::error_already_set();
+
+  auto array = py::reinterpret_steal<py::object>(object);
+  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject *>(object),
+                            owner.inc_ref().ptr()))
+    throw py::error_already_set();
+  return array;
+}
+
+/// Return a read-only numpy array holding the scalar fields of the function
+/// design points, which are copied as the points are not standard-layout.
+static py::object getNpArrayCopy(ArrayRef<FuncDesignPoint> points) {
+  _import_array();
+  npy_intp dims[] = {(npy_intp)points.size()};
+  auto object = PyArray_NewFromDescr(
+      &PyArray_Type, getFuncDesignPointDescr(), 1, dims, /*strides=*/nullptr,
+      /*data=*/nullptr, /*flags=*/0, /*obj=*/nullptr);
+  if (!object)
+    throw py::error_already_set();
+
+  auto array = reinterpret_cast<PyArrayObject *>(object);
+  auto records = reinterpret_cast<FuncDesignPointRecord *>(
+      PyArray_DATA(array));
+  for (auto pointAndIdx : llvm::enumerate(points))
+    records[pointAndIdx.index()] = {pointAndIdx.value().latency,
+                                    pointAndIdx.value().dspNum};
+  PyArray_CLEARFLAGS(array, NPY_ARRAY_WRITEABLE);
+  return py::reinterpret_steal<py::object>(object);
+}
+
+/// Track the numpy arrays viewing the buffers of a design space. As the buffers
+/// are reallocated when the design space is explored further, the exploration
+/// is refused while any of the views is alive.
+class PyDesignPointViews {
+public:
+  py::object track(py::object array) {
+    views.push_back(py::weakref(array));
+    return array;
+  }
+
+  void checkNoAliveViews() {
+    for (auto &view : views)
+      if (!view().is_none())
+        throw SetPyError(PyExc_RuntimeError,
+                         "design points are viewed by alive numpy arrays, "
+                         "delete them before exploring further");
+    views.clear();
+  }
+
+private:
+  SmallVector<py::weakref, 4> views;
+};
+
+//===----------------------------------------------------------------------===//
+// Thread safety
+//===----------------------------------------------------------------------===//
+
+// The transform, estimation, and exploration APIs release the GIL while the C++
+// work is running, such that the IR of different MLIR contexts can be processed
+// by multiple Python threads in parallel. Python objects are converted and the
+// arguments are checked before the GIL is released, as raising a Python error
+// requires the GIL. The following guarantees are provided:
+//
+// * Calls on the IR of different contexts can run concurrently.
+// * Calls on the IR of the same context must be serialized by the caller, as
+//   the transforms may mutate the shared module, which is not thread-safe.
+// * An Estimator must not be used by multiple threads concurrently, which is
+//   checked and raises a RuntimeError. This includes the design spaces created
+//   with the estimator, thus each thread should create its own estimator.
+
 //===----------------------------------------------------------------------===//
 // Loop transform APIs
 //===----------------------------------------------------------------------===//
 
 static bool loopPerfectization(PyAffineLoopBand band) {
-  py::gil_scoped_release();
+  py::gil_scoped_release release;
   return applyAffineLoopPerfection(band.get());
 }
 
 static bool loopOrderOpt(PyAffineLoopBand band) {
-  py::gil_scoped_release();
+  py::gil_scoped_release release;
   return applyAffineLoopOrderOpt(band.get());
 }
 
 static bool loopPermutation(PyAffineLoopBand band, py::object permMapObject) {
-  py::gil_scoped_release();
   SmallVector<unsigned, 8> permMap;
   getVectorFromUnsignedNpArray(permMapObject.ptr(), permMap);
+  py::gil_scoped_release release;
   return applyAffineLoopOrderOpt(band.get(), permMap);
 }
 
 /// Loop variable bound elimination.
 static bool loopVarBoundRemoval(PyAffineLoopBand band) {
-  py::gil_scoped_release();
+  py::gil_scoped_release release;
   return applyRemoveVariableBound(band.get());
 }
 
 static bool loopTiling(PyAffineLoopBand band, py::object factorsObject) {
-  py::gil_scoped_release();
   llvm::SmallVector<unsigned, 8> factors;
   getVectorFromUnsignedNpArray(factorsObject.ptr(), factors);
+  py::gil_scoped_release release;
   return applyLoopTiling(band.get(), factors);
 }
 
 static bool loopPipelining(PyAffineLoopBand band, int64_t pipelineLoc,
                            int64_t targetII) {
-  py::gil_scoped_release();
   if (pipelineLoc < 0 || pipelineLoc >= (int64_t)band.depth() || targetII < 1)
     throw SetPyError(PyExc_ValueError, "invalid location or targeted II");
+  py::gil_scoped_release release;
   return applyLoopPipelining(band.get(), pipelineLoc, targetII);
 }
 
@@ -189,26 +334,26 @@ static bool loopPipelining(PyAffineLoopBand band, int64_t pipelineLoc,
 //===----------------------------------------------------------------------===//
 
 static bool funcPreprocess(MlirOperation op, bool topFunc) {
-  py::gil_scoped_release();
   auto func = dyn_cast<func::FuncOp>(unwrap(op));
   if (!func)
     throw SetPyError(PyExc_ValueError, "targeted operation not a function");
+  py::gil_scoped_release release;
   return applyFuncPreprocess(func, topFunc);
 }
 
 static bool memoryOpts(MlirOperation op) {
-  py::gil_scoped_release();
   auto func = dyn_cast<func::FuncOp>(unwrap(op));
   if (!func)
     throw SetPyError(PyExc_ValueError, "targeted operation not a function");
+  py::gil_scoped_release release;
   return applyMemoryOpts(func);
 }
 
 static bool autoArrayPartition(MlirOperation op) {
-  py::gil_scoped_release();
   auto func = dyn_cast<func::FuncOp>(unwrap(op));
   if (!func)
     throw SetPyError(PyExc_ValueError, "targeted operation not a function");
+  py::gil_scoped_release release;
   return applyAutoArrayPartition(func);
 }
 
@@ -219,23 +364,331 @@ static bool autoArrayPartition(MlirOperation op) {
 /// TODO: Support to apply different partition kind to different dimension.
 static bool arrayPartition(MlirValue array, py::object factorsObject,
                            std::string kind) {
-  py::gil_scoped_release();
   llvm::SmallVector<unsigned, 4> factors;
   getVectorFromUnsignedNpArray(factorsObject.ptr(), factors);
   llvm::SmallVector<hls::PartitionKind, 4> kinds(
       factors.size(), kind == "cyclic"  ? hls::PartitionKind::CYCLIC
                       : kind == "block" ? hls::PartitionKind::BLOCK
                                         : hls::PartitionKind::NONE);
+  py::gil_scoped_release release;
   return applyArrayPartition(unwrap(array), factors, kinds);
 }
 
+//===----------------------------------------------------------------------===//
+// Estimation and exploration APIs
+//===----------------------------------------------------------------------===//
+
+static func::FuncOp getFuncOp(MlirOperation op) {
+  auto func = dyn_cast<func::FuncOp>(unwrap(op));
+  if (!func)
+    throw SetPyError(PyExc_ValueError, "targeted operation not a function");
+  if (!llvm::hasSingleElement(func.getBody()))
+    throw SetPyError(PyExc_ValueError, "function must have single block");
+  return func;
+}
+
+/// An estimator and the DSE configurations parsed from a target spec JSON file.
+/// The estimator refers to the profiling data held by this class, thus it can't
+/// be copied or moved.
+class PyEstimator {
+public:
+  PyEstimator(std::string targetSpec) {
+    auto buffer = llvm::MemoryBuffer::getFile(targetSpec);
+    if (!buffer)
+      throw SetPyError(PyExc_ValueError,
+                       "failed to read the target spec json file");
+    auto config = llvm::json::parse(buffer.get()->getBuffer());
+    if (!config) {
+      llvm::consumeError(config.takeError());
+      throw SetPyError(PyExc_ValueError,
+                       "failed to parse the target spec json file");
+    }
+    auto configObj = config.get().getAsObject();
+    if (!configObj)
+      throw SetPyError(PyExc_ValueError,
+                       "support an object in the target spec json file, found "
+                       "something else");
+
+    // Collect DSE configurations with the same defaults as the DSE pass.
+    maxInitParallel = configObj->getInteger("max_init_parallel").value_or(32);
+    maxExplParallel =
+        configObj->getInteger("max_expl_parallel").value_or(1024);
+    maxLoopParallel = configObj->getInteger("max_loop_parallel").value_or(128);
+    maxIterNum = configObj->getInteger("max_iter_num").value_or(30);
+    maxDistance = configObj->getNumber("max_distance").value_or(3.0);
+    randomSeed = configObj->getInteger("random_seed").value_or(0);
+    directiveOnly = configObj->getBoolean("directive_only").value_or(false);
+    maxDspNum = configObj->getBoolean("resource_constr").value_or(true)
+                    ? ceil(configObj->getInteger("dsp").value_or(220) * 1.1)
+                    : UINT_MAX;
+
+    getLatencyMap(configObj, latencyMap);
+    getDspUsageMap(configObj, dspUsageMap);
+    getLutUsageMap(configObj, lutUsageMap);
+    getFfUsageMap(configObj, ffUsageMap);
+    getAxiMap(configObj, axiMap);
+    getDelayMap(configObj, delayMap);
+    estimator = std::make_unique<ScaleHLSEstimator>(
+        latencyMap, dspUsageMap, lutUsageMap, ffUsageMap, axiMap, delayMap,
+        getClockPeriod(configObj), true);
+  }
+  PyEstimator(const PyEstimator &) = delete;
+
+  /// Claim the exclusive use of the estimator, whose scheduling information is
+  /// not thread-safe. A claim must be made before the GIL is released.
+  class Claim {
+  public:
+    Claim(PyEstimator &estimator) : estimator(estimator) {
+      if (estimator.busy.exchange(true))
+        throw SetPyError(PyExc_RuntimeError,
+                         "estimator is being used by another thread");
+    }
+    ~Claim() { estimator.busy = false; }
+
+  private:
+    PyEstimator &estimator;
+  };
+
+  ScaleHLSEstimator &get() const { return *estimator; }
+
+  /// Estimate the function and return its latency, interval, and resource
+  /// utilization. If "materialize" is true, the estimation results are also
+  /// materialized into the attributes of the function.
+  py::dict estimateFunc(MlirOperation op, bool materialize) {
+    auto func = getFuncOp(op);
+    EstimatedTiming timing;
+    EstimatedResource resource;
+    {
+      Claim claim(*this);
+      py::gil_scoped_release release;
+      estimator->estimateFunc(func);
+      if (materialize)
+        estimator->materializeAttributes(func);
+      timing = estimator->getTiming(func);
+      resource = estimator->getResource(func);
+    }
+
+    py::dict results;
+    results["latency"] = timing.getLatency();
+    results["interval"] = timing.getInterval();
+    results["lut"] = resource.getLut();
+    results["dsp"] = resource.getDsp();
+    results["bram"] = resource.getBram();
+    results["ff"] = resource.getFf();
+    return results;
+  }
+
+  /// Estimate the loop band in the function and return the latency and resource
+  /// utilization of the outermost loop. If the innermost loop is pipelined, its
+  /// achieved II and iteration latency are returned as well.
+  py::dict estimateLoopBand(PyAffineLoopBand band, MlirOperation op) {
+    auto func = getFuncOp(op);
+    if (!band.depth())
+      throw SetPyError(PyExc_ValueError, "loop band must not be empty");
+    auto outerLoop = band.get().front();
+    EstimatedTiming timing;
+    EstimatedResource resource;
+    EstimatedLoopInfo info;
+    {
+      Claim claim(*this);
+      py::gil_scoped_release release;
+      estimator->estimateLoop(outerLoop, func);
+      timing = estimator->getTiming(outerLoop);
+      resource = estimator->getResource(outerLoop);
+      info = estimator->getLoopInfo(band.get().back());
+    }
+
+    py::dict results;
+    results["latency"] = timing.getLatency();
+    results["interval"] = timing.getInterval();
+    results["lut"] = resource.getLut();
+    results["dsp"] = resource.getDsp();
+    results["bram"] = resource.getBram();
+    results["ff"] = resource.getFf();
+    if (info) {
+      results["ii"] = info.getMinII();
+      results["iter_latency"] = info.getIterLatency();
+    }
+    return results;
+  }
+
+  // DSE configurations.
+  unsigned maxDspNum;
+  unsigned maxInitParallel;
+  unsigned maxExplParallel;
+  unsigned maxLoopParallel;
+  unsigned maxIterNum;
+  float maxDistance;
+  unsigned randomSeed;
+  bool directiveOnly;
+
+private:
+  llvm::StringMap<int64_t> latencyMap;
+  llvm::StringMap<int64_t> dspUsageMap;
+  llvm::StringMap<int64_t> lutUsageMap;
+  llvm::StringMap<int64_t> ffUsageMap;
+  llvm::StringMap<int64_t> axiMap;
+  llvm::StringMap<double> delayMap;
+  std::unique_ptr<ScaleHLSEstimator> estimator;
+  std::atomic<bool> busy{false};
+};
+
+/// The design space of a loop band. Temporary loop bands are inserted into the
+/// function during each evaluation and erased afterwards, thus the function is
+/// not changed by the exploration. The DSE configurations of the estimator are
+/// used unless they are given explicitly.
+class PyLoopDesignSpace {
+public:
+  PyLoopDesignSpace(PyEstimator &estimator, MlirOperation op,
+                    PyAffineLoopBand band)
+      : estimator(estimator), band(band.get()) {
+    auto func = getFuncOp(op);
+    if (this->band.empty())
+      throw SetPyError(PyExc_ValueError, "loop band must not be empty");
+    space = std::make_unique<LoopDesignSpace>(
+        func, this->band, estimator.get(), estimator.maxDspNum,
+        estimator.maxExplParallel, estimator.maxLoopParallel,
+        estimator.directiveOnly, estimator.randomSeed);
+  }
+  PyLoopDesignSpace(const PyLoopDesignSpace &) = delete;
+
+  LoopDesignSpace &get() const { return *space; }
+
+  void initialize(unsigned maxInitParallel) {
+    PyEstimator::Claim claim(estimator);
+    views.checkNoAliveViews();
+    py::gil_scoped_release release;
+    space->initializeLoopDesignSpace(
+        maxInitParallel ? maxInitParallel : estimator.maxInitParallel);
+  }
+
+  void explore(unsigned maxIterNum, float maxDistance) {
+    PyEstimator::Claim claim(estimator);
+    views.checkNoAliveViews();
+    py::gil_scoped_release release;
+    space->exploreLoopDesignSpace(maxIterNum ? maxIterNum
+                                             : estimator.maxIterNum,
+                                  maxDistance > 0 ? maxDistance
+                                                  : estimator.maxDistance);
+  }
+
+  py::list getTileList(TileConfig config) {
+    PyEstimator::Claim claim(estimator);
+    if (config >= space->validTileConfigNum)
+      throw SetPyError(PyExc_ValueError, "invalid tile config");
+    py::list tileList;
+    for (auto tile : space->getTileList(config))
+      tileList.append(tile);
+    return tileList;
+  }
+
+  /// The pareto and all evaluated points are returned as views of the buffers
+  /// held by the design space rather than copies. The views hold a reference to
+  /// the design space, which owns the buffers.
+  static py::object getParetoPoints(py::object self) {
+    auto &pySpace = self.cast<PyLoopDesignSpace &>();
+    PyEstimator::Claim claim(pySpace.estimator);
+    auto &points = pySpace.space->paretoPoints;
+    return pySpace.views.track(getNpArrayView(
+        getLoopDesignPointDescr(), points.data(), points.size(), self));
+  }
+
+  static py::object getAllPoints(py::object self) {
+    auto &pySpace = self.cast<PyLoopDesignSpace &>();
+    PyEstimator::Claim claim(pySpace.estimator);
+    auto &points = pySpace.space->allPoints;
+    return pySpace.views.track(getNpArrayView(
+        getLoopDesignPointDescr(), points.data(), points.size(), self));
+  }
+
+private:
+  PyEstimator &estimator;
+  AffineLoopBand band;
+  std::unique_ptr<LoopDesignSpace> space;
+  PyDesignPointViews views;
+};
+
+/// The design space of a function combined from the design spaces of all its
+/// loop bands, which must be given in the order of the loop bands and are
+/// copied at construction. The parent module of the function is cloned as the
+/// combination annotates the outermost loops of the bands.
+class PyFuncDesignSpace {
+public:
+  PyFuncDesignSpace(PyEstimator &estimator, MlirOperation op,
+                    py::list loopSpaceList)
+      : estimator(estimator) {
+    auto func = getFuncOp(op);
+    AffineLoopBands bands;
+    getLoopBands(func.front(), bands);
+    if (bands.empty() || bands.size() != loopSpaceList.size())
+      throw SetPyError(PyExc_ValueError,
+                       "expect one loop design space for each loop band");
+
+    // Hold the loop design spaces, which are referred by their copies.
+    for (auto loopSpace : loopSpaceList) {
+      loopSpaceObjects.push_back(py::reinterpret_borrow<py::object>(loopSpace));
+      loopSpaces.push_back(loopSpace.cast<PyLoopDesignSpace &>().get());
+    }
+
+    // The whole module is cloned such that the callees of the function can be
+    // looked up by the estimator.
+    auto module = func->getParentOfType<ModuleOp>();
+    if (!module)
+      throw SetPyError(PyExc_ValueError, "function must be in a module");
+    tmpModule = module.clone();
+    auto tmpFunc = tmpModule->lookupSymbol<func::FuncOp>(func.getName());
+    space = std::make_unique<FuncDesignSpace>(tmpFunc, loopSpaces,
+                                              estimator.get(),
+                                              estimator.maxDspNum);
+  }
+  PyFuncDesignSpace(const PyFuncDesignSpace &) = delete;
+  ~PyFuncDesignSpace() { space.reset(); }
+
+  void combine() {
+    PyEstimator::Claim claim(estimator);
+    views.checkNoAliveViews();
+    py::gil_scoped_release release;
+    space->paretoPoints.clear();
+    space->combLoopDesignSpaces();
+  }
+
+  /// The pareto points are copied, while the loop design points of each pareto
+  /// point are returned as views.
+  static py::object getParetoPoints(py::object self) {
+    auto &pySpace = self.cast<PyFuncDesignSpace &>();
+    PyEstimator::Claim claim(pySpace.estimator);
+    return getNpArrayCopy(pySpace.space->paretoPoints);
+  }
+
+  /// Return the loop design points of each loop band that compose the given
+  /// pareto point of the function.
+  static py::object getLoopPoints(py::object self, size_t index) {
+    auto &pySpace = self.cast<PyFuncDesignSpace &>();
+    PyEstimator::Claim claim(pySpace.estimator);
+    if (index >= pySpace.space->paretoPoints.size())
+      throw SetPyError(PyExc_IndexError, "pareto point index out of range");
+    auto &points = pySpace.space->paretoPoints[index].loopDesignPoints;
+    return pySpace.views.track(getNpArrayView(
+        getLoopDesignPointDescr(), points.data(), points.size(), self));
+  }
+
+private:
+  PyEstimator &estimator;
+  std::vector<py::object> loopSpaceObjects;
+  SmallVector<LoopDesignSpace, 4> loopSpaces;
+  OwningOpRef<ModuleOp> tmpModule;
+  std::unique_ptr<FuncDesignSpace> space;
+  PyDesignPointViews views;
+};
+
 //===----------------------------------------------------------------------===//
 // Emission APIs
 //===----------------------------------------------------------------------===//
 
 static bool emitHlsCpp(MlirModule mod, py::object fileObject) {
+  // The GIL is re-acquired by the accumulator when writing to the file.
   PyFileAccumulator accum(fileObject, false);
-  py::gil_scoped_release();
+  py::gil_scoped_release release;
   return mlirLogicalResultIsSuccess(
       mlirEmitHlsCpp(mod, accum.getCallback(), accum.getUserData()));
 }
@@ -278,6 +731,38 @@ PYBIND11_MODULE(_scalehls, m) {
   // Emission APIs.
   m.def("emit_hlscpp", &emitHlsCpp);
 
+  // Estimation and exploration APIs.
+  py::class_<PyEstimator>(m, "Estimator", py::module_local())
+      .def(py::init<std::string>(), py::arg("target_spec"))
+      .def("estimate_func", &PyEstimator::estimateFunc, py::arg("op"),
+           py::arg("materialize") = false)
+      .def("estimate_loop_band", &PyEstimator::estimateLoopBand,
+           py::arg("band"), py::arg("op"));
+
+  py::class_<PyLoopDesignSpace>(m, "LoopDesignSpace", py::module_local())
+      .def(py::init<PyEstimator &, MlirOperation, PyAffineLoopBand>(),
+           py::arg("estimator"), py::arg("op"), py::arg("band"),
+           py::keep_alive<1, 2>())
+      .def("initialize", &PyLoopDesignSpace::initialize,
+           py::arg("max_init_parallel") = 0)
+      .def("explore", &PyLoopDesignSpace::explore,
+           py::arg("max_iter_num") = 0, py::arg("max_distance") = 0.0f)
+      .def("get_tile_list", &PyLoopDesignSpace::getTileList,
+           py::arg("tile_config"))
+      .def_property_readonly("pareto_points",
+                             &PyLoopDesignSpace::getParetoPoints)
+      .def_property_readonly("all_points", &PyLoopDesignSpace::getAllPoints);
+
+  py::class_<PyFuncDesignSpace>(m, "FuncDesignSpace", py::module_local())
+      .def(py::init<PyEstimator &, MlirOperation, py::list>(),
+           py::arg("estimator"), py::arg("op"), py::arg("loop_spaces"),
+           py::keep_alive<1, 2>())
+      .def("combine", &PyFuncDesignSpace::combine)
+      .def_property_readonly("pareto_points",
+                             &PyFuncDesignSpace::getParetoPoints)
+      .def("get_loop_points", &PyFuncDesignSpace::getLoopPoints,
+           py::arg("index"));
+
   // Customized Python classes.
   py::class_<PyAffineLoopBand>(m, "LoopBand", py::module_local())
       .def_property_readonly("depth", &PyAffineLoopBand::depth)
@@ -1065,8 +1065,9 @@ ResourceAttr hls::getResource(Operation *op) {
 void hls::setResource(Operation *op, ResourceAttr resource) {
   op->setAttr("resource", resource);
 }
-void hls::setResource(Operation *op, int64_t lut, int64_t dsp, int64_t bram) {
-  auto resource = ResourceAttr::get(op->getContext(), lut, dsp, bram);
+void hls::setResource(Operation *op, int64_t lut, int64_t dsp, int64_t bram,
+                      int64_t ff) {
+  auto resource = ResourceAttr::get(op->getContext(), lut, dsp, bram, ff);
   setResource(op, resource);
 }
 
@@ -1112,6 +1113,35 @@ bool hls::hasPointAttr(Operation *op) {
   return op->hasAttrOfType<UnitAttr>("point");
 }
 
+/// Unroll attribute utils of parallel loops.
+void hls::setUnrollAttr(Operation *op) {
+  op->setAttr("unroll", UnitAttr::get(op->getContext()));
+}
+bool hls::hasUnrollAttr(Operation *op) {
+  return op->hasAttrOfType<UnitAttr>("unroll");
+}
+
+/// Profiled trip count and branch probability attribute utils.
+Optional<int64_t> hls::getProfiledTripCount(Operation *op) {
+  if (auto tripCount = op->getAttrOfType<IntegerAttr>("trip_count"))
+    return tripCount.getInt();
+  return Optional<int64_t>();
+}
+void hls::setProfiledTripCount(Operation *op, int64_t tripCount) {
+  op->setAttr("trip_count",
+              IntegerAttr::get(IntegerType::get(op->getContext(), 64),
+                               tripCount));
+}
+Optional<double> hls::getThenProbability(Operation *op) {
+  if (auto probability = op->getAttrOfType<FloatAttr>("then_probability"))
+    return probability.getValueAsDouble();
+  return Optional<double>();
+}
+void hls::setThenProbability(Operation *op, double probability) {
+  op->setAttr("then_probability",
+              FloatAttr::get(Float64Type::get(op->getContext()), probability));
+}
+
 /// Function directives attribute utils.
 FuncDirectiveAttr hls::getFuncDirective(Operation *op) {
   return op->getAttrOfType<FuncDirectiveAttr>("func_directive");
@@ -1150,19 +1180,25 @@ Attribute ResourceAttr::parse(AsmParser &p, Type type) {
   if (p.parseLess() || p.parseKeyword(&lutKw) || p.parseEqual() ||
       p.parseInteger(lut) || p.parseComma() || p.parseKeyword(&dspKw) ||
       p.parseEqual() || p.parseInteger(dsp) || p.parseComma() ||
-      p.parseKeyword(&bramKw) || p.parseEqual() || p.parseInteger(bram) ||
-      p.parseGreater())
+      p.parseKeyword(&bramKw) || p.parseEqual() || p.parseInteger(bram))
     return Attribute();
 
   if (lutKw != "lut" || dspKw != "dsp" || bramKw != "bram")
     return Attribute();
 
-  return ResourceAttr::get(p.getContext(), lut, dsp, bram);
+  int64_t ff = 0;
+  if (succeeded(p.parseOptionalComma()))
+    if (p.parseKeyword("ff") || p.parseEqual() || p.parseInteger(ff))
+      return Attribute();
+  if (p.parseGreater())
+    return Attribute();
+
+  return ResourceAttr::get(p.getContext(), lut, dsp, bram, ff);
 }
 
 void ResourceAttr::print(AsmPrinter &p) const {
   p << "<lut=" << getLut() << ", dsp=" << getDsp() << ", bram=" << getBram()
-    << ">";
+    << ", ff=" << getFf() << ">";
 }
 
 //===----------------------------------------------------------------------===//
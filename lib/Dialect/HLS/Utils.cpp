@@ -11,6 +11,7 @@
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Tosa/IR/TosaOps.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "mlir/IR/Dominance.h"
 #include "mlir/IR/IntegerSet.h"
@@ -878,6 +879,8 @@ void scalehls::getArrays(Block &block, SmallVectorImpl<Value> &arrays,
 Optional<unsigned> scalehls::getAverageTripCount(AffineForOp forOp) {
   if (auto optionalTripCount = getConstantTripCount(forOp))
     return optionalTripCount.value();
+  else if (auto profiledTripCount = getProfiledTripCount(forOp))
+    return profiledTripCount.value();
   else {
     // TODO: A temporary approach to estimate the trip count. For now, we take
     // the average of the upper bound and lower bound of trip count as the
@@ -898,6 +901,51 @@ Optional<unsigned> scalehls::getAverageTripCount(AffineForOp forOp) {
   }
 }
 
+Optional<int64_t> scalehls::getParallelTripCount(Operation *op) {
+  SmallVector<Optional<int64_t>, 4> lowerBounds;
+  SmallVector<Optional<int64_t>, 4> upperBounds;
+  SmallVector<Optional<int64_t>, 4> steps;
+  if (auto loop = dyn_cast<AffineParallelOp>(op)) {
+    auto ranges = loop.getConstantRanges();
+    if (!ranges)
+      return Optional<int64_t>();
+    lowerBounds.append(ranges->size(), 0);
+    upperBounds.append(ranges->begin(), ranges->end());
+    for (auto step : loop.getSteps())
+      steps.push_back(step);
+  } else if (auto loop = dyn_cast<scf::ParallelOp>(op)) {
+    for (unsigned i = 0, e = loop.getNumLoops(); i < e; ++i) {
+      lowerBounds.push_back(getConstantIntValue(loop.getLowerBound()[i]));
+      upperBounds.push_back(getConstantIntValue(loop.getUpperBound()[i]));
+      steps.push_back(getConstantIntValue(loop.getStep()[i]));
+    }
+  } else
+    return Optional<int64_t>();
+
+  int64_t tripCount = 1;
+  for (unsigned i = 0, e = steps.size(); i < e; ++i) {
+    auto lowerBound = lowerBounds[i];
+    auto upperBound = upperBounds[i];
+    auto step = steps[i];
+    if (!lowerBound || !upperBound || !step || step.value() <= 0)
+      return Optional<int64_t>();
+    auto range = upperBound.value() - lowerBound.value();
+    tripCount *= range > 0 ? (range + step.value() - 1) / step.value() : 0;
+  }
+  return tripCount;
+}
+
+/// Parallel loops with a constant trip count up to this number are unrolled by
+/// default, as the replicas of their bodies don't cost too many resources.
+static constexpr int64_t maxUnrolledParallelTripCount = 16;
+
+bool scalehls::isUnrolledParallelLoop(Operation *op) {
+  if (hasUnrollAttr(op))
+    return true;
+  auto tripCount = getParallelTripCount(op);
+  return tripCount && tripCount.value() <= maxUnrolledParallelTripCount;
+}
+
 bool scalehls::checkDependence(Operation *A, Operation *B) {
   AffineLoopBand commonLoops;
   unsigned numCommonLoops = getCommonSurroundingLoops(A, B, &commonLoops);
@@ -0,0 +1,17 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2020-2021 The ScaleHLS Authors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scalehls/Profile/Passes.h"
+
+using namespace mlir;
+using namespace scalehls;
+
+namespace {
+#define GEN_PASS_REGISTRATION
+#include "scalehls/Profile/Passes.h.inc"
+} // namespace
+
+void scalehls::registerProfilePasses() { registerPasses(); }
@@ -0,0 +1,324 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2020-2021 The ScaleHLS Authors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Conversion/Passes.h"
+#include "mlir/ExecutionEngine/ExecutionEngine.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Target/LLVMIR/Dialect/Builtin/BuiltinToLLVMIRTranslation.h"
+#include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
+#include "scalehls/Profile/Passes.h"
+#include "scalehls/Transforms/Utils.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetSelect.h"
+#include <cstring>
+#include <random>
+
+using namespace mlir;
+using namespace scalehls;
+using namespace hls;
+
+static constexpr StringLiteral profileCounterName = "__scalehls_profile";
+
+/// Return whether the operation is profiled. For each loop, the number of
+/// entries and the total number of iterations are recorded. For each branch,
+/// the number of executions and the number of times its "then" side is taken
+/// are recorded.
+static bool isProfiledOp(Operation *op) {
+  return isa<AffineForOp, scf::ForOp, scf::WhileOp, AffineIfOp, scf::IfOp>(op);
+}
+
+/// Return the block executed once in each iteration of a loop, or in each time
+/// the "then" side of a branch is taken.
+static Block *getProfiledBlock(Operation *op) {
+  if (auto loop = dyn_cast<AffineForOp>(op))
+    return loop.getBody();
+  if (auto loop = dyn_cast<scf::ForOp>(op))
+    return loop.getBody();
+  if (auto loop = dyn_cast<scf::WhileOp>(op))
+    return &loop.getAfter().front();
+  if (auto ifOp = dyn_cast<AffineIfOp>(op))
+    return ifOp.getThenBlock();
+  return cast<scf::IfOp>(op).thenBlock();
+}
+
+/// Increase the counter at the given index by one.
+static void increaseCounter(OpBuilder &builder, Location loc, Value counters,
+                            int64_t index) {
+  Value indexValue = builder.create<arith::ConstantIndexOp>(loc, index);
+  auto count = builder.create<memref::LoadOp>(loc, counters, indexValue);
+  auto one = builder.create<arith::ConstantIntOp>(loc, 1, 64);
+  auto newCount = builder.create<arith::AddIOp>(loc, count, one);
+  builder.create<memref::StoreOp>(loc, newCount, counters, indexValue);
+}
+
+/// Return the number of bytes of the type in the host memory, where index type
+/// is lowered to a 64-bits integer.
+static int64_t getByteWidth(Type type) {
+  if (type.isIndex())
+    return 8;
+  return (type.getIntOrFloatBitWidth() + 7) / 8;
+}
+
+/// Fill the data with random values, where integers are generated within a
+/// small range such that they can be used as loop bounds or memory indices.
+static void fillRandomData(char *data, Type type, int64_t num,
+                           std::mt19937 &generator) {
+  std::uniform_int_distribution<int64_t> intDistribution(0, 15);
+  std::uniform_real_distribution<double> floatDistribution(0.0, 1.0);
+  auto byteWidth = getByteWidth(type);
+
+  for (int64_t i = 0; i < num; ++i) {
+    auto element = data + i * byteWidth;
+    if (type.isF32()) {
+      float value = floatDistribution(generator);
+      memcpy(element, &value, sizeof(float));
+    } else if (type.isF64()) {
+      double value = floatDistribution(generator);
+      memcpy(element, &value, sizeof(double));
+    } else if (type.isIntOrIndex()) {
+      // Integers are stored in little-endian on the host.
+      auto value = intDistribution(generator);
+      if (type.isInteger(1))
+        value &= 1;
+      memcpy(element, &value, std::min(byteWidth, (int64_t)sizeof(int64_t)));
+    } else
+      memset(element, 0, byteWidth);
+  }
+}
+
+namespace {
+struct ProfileExecution : public ProfileExecutionBase<ProfileExecution> {
+  ProfileExecution() = default;
+  ProfileExecution(std::string hlsTopFunc, std::string profileInputDir) {
+    topFunc = hlsTopFunc;
+    inputDir = profileInputDir;
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    ProfileExecutionBase::getDependentDialects(registry);
+    registerBuiltinDialectTranslation(registry);
+    registerLLVMDialectTranslation(registry);
+  }
+
+  /// Load the data of the argument from the input directory if available, or
+  /// generate random data otherwise.
+  LogicalResult getArgumentData(unsigned argIdx, Type type, int64_t num,
+                                char *data, std::mt19937 &generator) {
+    auto byteWidth = getByteWidth(type);
+    if (inputDir.empty()) {
+      fillRandomData(data, type, num, generator);
+      return success();
+    }
+
+    auto filePath = inputDir + "/arg" + std::to_string(argIdx) + ".bin";
+    auto file = llvm::MemoryBuffer::getFile(filePath);
+    if (!file) {
+      fillRandomData(data, type, num, generator);
+      return success();
+    }
+    if ((int64_t)(*file)->getBufferSize() != num * byteWidth) {
+      emitError(getOperation().getLoc(), "size of ")
+          << filePath << " mismatches argument " << argIdx;
+      return failure();
+    }
+    memcpy(data, (*file)->getBufferStart(), num * byteWidth);
+    return success();
+  }
+
+  void runOnOperation() override {
+    auto module = getOperation();
+    auto context = module.getContext();
+    auto loc = module.getLoc();
+
+    // Get the top function of the module.
+    auto func = getTopFunc(module, topFunc);
+    if (!func) {
+      emitError(loc, "fail to find the top function");
+      return signalPassFailure();
+    }
+
+    // Only memrefs with static shapes in the default memory space and scalars
+    // are supported as arguments, and only scalars are supported as results.
+    for (auto type : func.getArgumentTypes()) {
+      auto memrefType = type.dyn_cast<MemRefType>();
+      if (memrefType && memrefType.hasStaticShape() &&
+          memrefType.getLayout().isIdentity() &&
+          !memrefType.getMemorySpace() &&
+          memrefType.getElementType().isIntOrIndexOrFloat())
+        continue;
+      if (type.isIntOrIndexOrFloat())
+        continue;
+      emitError(func.getLoc(), "unsupported argument type ") << type;
+      return signalPassFailure();
+    }
+    if (llvm::any_of(func.getResultTypes(),
+                     [](Type type) { return !type.isIntOrIndexOrFloat(); })) {
+      emitError(func.getLoc(), "only scalar results are supported");
+      return signalPassFailure();
+    }
+
+    // Collect all operations to be profiled. The cloned module is walked in
+    // the same order, thus the operations are matched by their positions.
+    SmallVector<Operation *, 32> profiledOps;
+    module.walk([&](Operation *op) {
+      if (isProfiledOp(op))
+        profiledOps.push_back(op);
+    });
+    if (profiledOps.empty())
+      return;
+
+    OwningOpRef<ModuleOp> profModule = module.clone();
+    SmallVector<Operation *, 32> clonedOps;
+    profModule->walk([&](Operation *op) {
+      if (isProfiledOp(op))
+        clonedOps.push_back(op);
+    });
+    assert(clonedOps.size() == profiledOps.size() && "mismatched clone");
+
+    // Create a global counter array and instrument each profiled operation.
+    OpBuilder builder(context);
+    builder.setInsertionPointToStart(profModule->getBody());
+    auto countersType = MemRefType::get(
+        {(int64_t)clonedOps.size() * 2}, builder.getIntegerType(64));
+    auto initialValue = builder.getZeroAttr(RankedTensorType::get(
+        countersType.getShape(), countersType.getElementType()));
+    builder.create<memref::GlobalOp>(loc, profileCounterName,
+                                     /*sym_visibility=*/StringAttr(),
+                                     countersType, initialValue,
+                                     /*constant=*/false,
+                                     /*alignment=*/IntegerAttr());
+
+    DenseMap<Operation *, Value> countersMap;
+    for (unsigned i = 0, e = clonedOps.size(); i < e; ++i) {
+      auto op = clonedOps[i];
+      auto parentFunc = op->getParentOfType<func::FuncOp>();
+      auto &counters = countersMap[parentFunc];
+      if (!counters) {
+        builder.setInsertionPointToStart(&parentFunc.front());
+        counters = builder.create<memref::GetGlobalOp>(loc, countersType,
+                                                       profileCounterName);
+      }
+
+      builder.setInsertionPoint(op);
+      increaseCounter(builder, op->getLoc(), counters, i * 2);
+      builder.setInsertionPointToStart(getProfiledBlock(op));
+      increaseCounter(builder, op->getLoc(), counters, i * 2 + 1);
+    }
+
+    // Lower the instrumented module to the LLVM dialect.
+    auto profFunc = profModule->lookupSymbol<func::FuncOp>(func.getName());
+    profFunc->setAttr("llvm.emit_c_interface", UnitAttr::get(context));
+
+    PassManager pm(context);
+    pm.addPass(mlir::createLowerAffinePass());
+    pm.addPass(createConvertSCFToCFPass());
+    pm.addPass(createConvertMathToLLVMPass());
+    pm.addPass(createArithToLLVMConversionPass());
+    pm.addPass(createMemRefToLLVMConversionPass());
+    pm.addPass(createConvertControlFlowToLLVMPass());
+    pm.addPass(createConvertFuncToLLVMPass());
+    pm.addPass(createReconcileUnrealizedCastsPass());
+    if (failed(pm.run(*profModule))) {
+      emitError(loc, "fail to lower the module to LLVM for profiling");
+      return signalPassFailure();
+    }
+
+    // Run the module on the host with the ExecutionEngine.
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    auto maybeEngine = ExecutionEngine::create(*profModule);
+    if (!maybeEngine) {
+      emitError(loc, "fail to create the execution engine: ")
+          << llvm::toString(maybeEngine.takeError());
+      return signalPassFailure();
+    }
+    auto &engine = maybeEngine.get();
+
+    // Prepare the packed arguments of the top function. Each memref is passed
+    // as a pointer to its descriptor, which holds the allocated and aligned
+    // pointers, the offset, and the sizes and strides of each dimension.
+    auto numArgs = func.getNumArguments();
+    std::mt19937 generator(seed);
+    std::vector<std::vector<char>> argData(numArgs);
+    std::vector<std::vector<int64_t>> descriptors(numArgs);
+    std::vector<void *> descriptorPtrs(numArgs);
+    std::vector<int64_t> scalars(numArgs);
+    std::vector<int64_t> results(func.getNumResults() + 1);
+    SmallVector<void *, 8> args;
+
+    for (unsigned i = 0; i < numArgs; ++i) {
+      auto type = func.getArgument(i).getType();
+      auto memrefType = type.dyn_cast<MemRefType>();
+      if (!memrefType) {
+        if (failed(getArgumentData(i, type, 1, (char *)&scalars[i],
+                                   generator)))
+          return signalPassFailure();
+        args.push_back(&scalars[i]);
+        continue;
+      }
+
+      auto elementType = memrefType.getElementType();
+      auto num = memrefType.getNumElements();
+      argData[i].resize(num * getByteWidth(elementType));
+      if (failed(getArgumentData(i, elementType, num, argData[i].data(),
+                                 generator)))
+        return signalPassFailure();
+
+      auto &descriptor = descriptors[i];
+      auto dataPtr = reinterpret_cast<int64_t>(argData[i].data());
+      descriptor = {dataPtr, dataPtr, 0};
+      descriptor.insert(descriptor.end(), memrefType.getShape().begin(),
+                        memrefType.getShape().end());
+      int64_t stride = 1;
+      SmallVector<int64_t, 4> strides;
+      for (auto size : llvm::reverse(memrefType.getShape())) {
+        strides.push_back(stride);
+        stride *= size;
+      }
+      descriptor.insert(descriptor.end(), strides.rbegin(), strides.rend());
+      descriptorPtrs[i] = descriptor.data();
+      args.push_back(&descriptorPtrs[i]);
+    }
+    if (func.getNumResults())
+      args.push_back(results.data());
+
+    if (auto error = engine->invokePacked(
+            ("_mlir_ciface_" + func.getName()).str(), args)) {
+      emitError(loc, "fail to execute the top function: ")
+          << llvm::toString(std::move(error));
+      return signalPassFailure();
+    }
+
+    // Annotate the profiled trip counts and branch probabilities.
+    auto countersAddr = engine->lookup(profileCounterName);
+    if (!countersAddr) {
+      emitError(loc, "fail to find the profile counters: ")
+          << llvm::toString(countersAddr.takeError());
+      return signalPassFailure();
+    }
+    auto counters = reinterpret_cast<int64_t *>(countersAddr.get());
+
+    for (unsigned i = 0, e = profiledOps.size(); i < e; ++i) {
+      auto op = profiledOps[i];
+      auto numEntries = counters[i * 2];
+      auto numTaken = counters[i * 2 + 1];
+      if (!numEntries)
+        continue;
+
+      if (isa<AffineIfOp, scf::IfOp>(op))
+        setThenProbability(op, (double)numTaken / numEntries);
+      else
+        setProfiledTripCount(op, (numTaken + numEntries / 2) / numEntries);
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<Pass>
+scalehls::createProfileExecutionPass(std::string hlsTopFunc,
+                                     std::string profileInputDir) {
+  return std::make_unique<ProfileExecution>(hlsTopFunc, profileInputDir);
+}
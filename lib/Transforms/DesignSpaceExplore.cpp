@@ -6,9 +6,11 @@
 
 #include "mlir/Dialect/Affine/Analysis/LoopAnalysis.h"
 #include "mlir/Dialect/Affine/Analysis/Utils.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Support/FileUtilities.h"
 #include "scalehls/Transforms/Explorer.h"
 #include "scalehls/Transforms/Passes.h"
+#include "scalehls/Translation/EmitHLSCpp.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ToolOutputFile.h"
@@ -75,21 +77,29 @@ static void emitTileListDebugInfo(FactorList tileList) {
 LoopDesignSpace::LoopDesignSpace(func::FuncOp func, AffineLoopBand &band,
                                  ScaleHLSEstimator &estimator,
                                  unsigned maxDspNum, unsigned maxExplParallel,
-                                 unsigned maxLoopParallel, bool directiveOnly)
-    : func(func), band(band), estimator(estimator), maxDspNum(maxDspNum) {
+                                 unsigned maxLoopParallel, bool directiveOnly,
+                                 unsigned randomSeed)
+    : func(func), band(band), estimator(estimator), maxDspNum(maxDspNum),
+      directiveOnly(directiveOnly),
+      randomEngine(randomSeed ? randomSeed : time(0)) {
   // Initialize tile vector related members.
   validTileConfigNum = 1;
   for (auto loop : band) {
-    auto optionalTripCount = getConstantTripCount(loop);
-    if (!optionalTripCount)
-      loop.emitError("has variable loop bound");
+    // Loops with variable bounds are not tiled, and their trip counts are
+    // taken from the profiling results if available.
+    auto optionalTripCount = getAverageTripCount(loop);
+    if (!optionalTripCount) {
+      loop.emitWarning("has variable loop bound without profiled trip count");
+      optionalTripCount = 1;
+    }
 
-    unsigned tripCount = optionalTripCount.value();
+    unsigned tripCount = std::max(optionalTripCount.value(), 1u);
     tripCountList.push_back(tripCount);
 
+    auto maxSize = getConstantTripCount(loop) ? maxLoopParallel : 1;
     SmallVector<unsigned, 8> validSizes;
     unsigned size = 1;
-    while (size <= std::min(tripCount, maxLoopParallel)) {
+    while (size <= std::min(tripCount, maxSize)) {
       // Push back the current size.
       validSizes.push_back(size);
 
@@ -204,21 +214,24 @@ bool LoopDesignSpace::evaluateTileConfig(TileConfig config) {
   // Annotate the current tile config as estimated.
   unestimatedTileConfigs.erase(config);
 
-  // Clone a temporary loop band by cloning the outermost loop.
-  auto outerLoop = band.front();
-  auto tmpOuterLoop = outerLoop.clone();
-  AffineLoopBand tmpBand;
-  getLoopBandFromOutermost(tmpOuterLoop, tmpBand);
+  auto tileList = getTileList(config);
+  emitTileListDebugInfo(tileList);
 
-  // Insert the clone loop band to the front of the original band for the
-  // convenience of the estimation.
-  auto builder = OpBuilder(func);
-  builder.setInsertionPoint(outerLoop);
-  builder.insert(tmpOuterLoop);
+  if (!evaluateTileConfig(config, /*flatten=*/true))
+    return false;
+
+  // If only directives are explored, the loop band is also evaluated without
+  // flattening. This could result in a smaller II because the dependencies
+  // carried by the outer loops are not involved in the II analysis.
+  if (directiveOnly && band.size() > 1)
+    evaluateTileConfig(config, /*flatten=*/false);
+  return true;
+}
 
-  // Apply the tile config and estimate the loop band.
+/// Evaluate all design points under the given tile config and flatten
+/// directive of the loops that perfectly nest the pipelined loop.
+bool LoopDesignSpace::evaluateTileConfig(TileConfig config, bool flatten) {
   auto tileList = getTileList(config);
-  emitTileListDebugInfo(tileList);
 
   // Calculate the total iteration number.
   unsigned iterNum = 1;
@@ -229,17 +242,31 @@ bool LoopDesignSpace::evaluateTileConfig(TileConfig config) {
   if (iterNum == 1)
     return false;
 
+  // Clone a temporary loop band by cloning the outermost loop.
+  auto outerLoop = band.front();
+  auto tmpOuterLoop = outerLoop.clone();
+  AffineLoopBand tmpBand;
+  getLoopBandFromOutermost(tmpOuterLoop, tmpBand);
+
+  // Insert the clone loop band to the front of the original band for the
+  // convenience of the estimation.
+  auto builder = OpBuilder(func);
+  builder.setInsertionPoint(outerLoop);
+  builder.insert(tmpOuterLoop);
+
   // Apply the current tiling config and start the estimation. Note that after
   // optimization, tmpBand is optimized in place and becomes a new loop band.
-  if (!applyOptStrategy(tmpBand, func, tileList, (unsigned)1))
+  if (!applyOptStrategy(tmpBand, func, tileList, (unsigned)1, flatten)) {
+    outerLoop->getPrevNode()->erase();
     return false;
+  }
   tmpOuterLoop = tmpBand.front();
   estimator.estimateLoop(tmpOuterLoop, func);
 
   // Fetch latency and resource utilization.
   auto tmpInnerLoop = tmpBand.back();
-  auto info = getLoopInfo(tmpInnerLoop);
-  auto resource = getResource(tmpOuterLoop);
+  auto info = estimator.getLoopInfo(tmpInnerLoop);
+  auto resource = estimator.getResource(tmpOuterLoop);
   assert(info && resource && "loop info or resource is not estimated");
   auto totalDsp = resource.getDsp() * info.getMinII();
 
@@ -249,8 +276,18 @@ bool LoopDesignSpace::evaluateTileConfig(TileConfig config) {
   for (auto tmpII = info.getMinII(); tmpII <= info.getIterLatency(); ++tmpII) {
     auto tmpDspNum = totalDsp / tmpII + 1;
     auto tmpLatency = info.getIterLatency() + tmpII * (iterNum - 1) + 2;
-    auto point = LoopDesignPoint(tmpLatency, tmpDspNum, config, tmpII);
 
+    // If not flattened, the pipelined loop is sequentially executed by each
+    // iteration of the outer loops, where entering and leaving each outer loop
+    // will consume extra 2 clock cycles.
+    if (!flatten) {
+      auto innerIterNum = tripCountList.back() / tileList.back();
+      tmpLatency = info.getIterLatency() + tmpII * (innerIterNum - 1) + 2;
+      for (unsigned i = tileList.size() - 1; i > 0; --i)
+        tmpLatency = tmpLatency * (tripCountList[i - 1] / tileList[i - 1]) + 2;
+    }
+
+    auto point = LoopDesignPoint(tmpLatency, tmpDspNum, config, tmpII, flatten);
     allPoints.push_back(point);
     if (tmpDspNum <= maxDspNum)
       paretoPoints.push_back(point);
@@ -293,22 +330,22 @@ void LoopDesignSpace::dumpLoopDesignSpace(StringRef csvFilePath) {
   // Print header row.
   for (unsigned i = 0; i < tripCountList.size(); ++i)
     os << "l" << i << ",";
-  os << "ii,cycle,dsp,type\n";
+  os << "ii,flatten,cycle,dsp,type\n";
 
   // Print pareto design points.
   for (auto &point : paretoPoints) {
     for (auto size : getTileList(point.tileConfig))
       os << size << ",";
-    os << point.targetII << "," << point.latency << "," << point.dspNum
-       << ",pareto\n";
+    os << point.targetII << "," << point.flatten << "," << point.latency << ","
+       << point.dspNum << ",pareto\n";
   }
 
   // Print all design points.
   for (auto &point : allPoints) {
     for (auto size : getTileList(point.tileConfig))
       os << size << ",";
-    os << point.targetII << "," << point.latency << "," << point.dspNum
-       << ",non-pareto\n";
+    os << point.targetII << "," << point.flatten << "," << point.latency << ","
+       << point.dspNum << ",non-pareto\n";
   }
 
   csvFile->keep();
@@ -346,9 +383,7 @@ LoopDesignSpace::getRandomClosestNeighbor(LoopDesignPoint point,
   }
 
   // Randomly pick one as the return point.
-  std::srand(time(0));
-  llvm::shuffle(closestConfigs.begin(), closestConfigs.end(),
-                []() { return std::rand(); });
+  llvm::shuffle(closestConfigs.begin(), closestConfigs.end(), randomEngine);
 
   return closestConfigs.front();
 }
@@ -359,9 +394,7 @@ void LoopDesignSpace::exploreLoopDesignSpace(unsigned maxIterNum,
 
   // Exploration loop of the dse.
   for (unsigned i = 0; i < maxIterNum; ++i) {
-    std::srand(time(0));
-    llvm::shuffle(paretoPoints.begin(), paretoPoints.end(),
-                  []() { return std::rand(); });
+    llvm::shuffle(paretoPoints.begin(), paretoPoints.end(), randomEngine);
 
     bool foundValidNeighbor = false;
     for (auto &point : paretoPoints) {
@@ -409,7 +442,7 @@ void FuncDesignSpace::dumpFuncDesignSpace(StringRef csvFilePath) {
 
     for (unsigned j = 0, ej = loopSpace.tripCountList.size(); j < ej; ++j)
       os << "b" << i << "l" << j << ",";
-    os << "b" << i << "ii,";
+    os << "b" << i << "ii,b" << i << "flatten,";
   }
   os << "cycle,dsp,type\n";
 
@@ -421,7 +454,7 @@ void FuncDesignSpace::dumpFuncDesignSpace(StringRef csvFilePath) {
 
       for (auto size : loopSpace.getTileList(loopPoint.tileConfig))
         os << size << ",";
-      os << loopPoint.targetII << ",";
+      os << loopPoint.targetII << "," << loopPoint.flatten << ",";
     }
     os << funcPoint.latency << "," << funcPoint.dspNum << ",pareto\n";
   }
@@ -444,8 +477,8 @@ void FuncDesignSpace::combLoopDesignSpaces() {
 
     // Estimate the function and generate a new function design point.
     estimator.estimateFunc(func);
-    auto latency = getTiming(func).getLatency();
-    auto dspNum = getResource(func).getDsp();
+    auto latency = estimator.getTiming(func).getLatency();
+    auto dspNum = estimator.getResource(func).getDsp();
     auto funcPoint = FuncDesignPoint(latency, dspNum, loopPoint);
 
     paretoPoints.push_back(funcPoint);
@@ -483,8 +516,8 @@ void FuncDesignSpace::combLoopDesignSpaces() {
         loopPoints.push_back(loopPoint);
 
         estimator.estimateFunc(func);
-        auto latency = getTiming(func).getLatency();
-        auto dspNum = getResource(func).getDsp();
+        auto latency = estimator.getTiming(func).getLatency();
+        auto dspNum = estimator.getResource(func).getDsp();
         auto newFuncPoint = FuncDesignPoint(latency, dspNum, loopPoints);
 
         newParetoPoints.push_back(newFuncPoint);
@@ -500,54 +533,91 @@ void FuncDesignSpace::combLoopDesignSpaces() {
   LLVM_DEBUG(llvm::dbgs() << "\n";);
 }
 
-bool FuncDesignSpace::exportParetoDesigns(unsigned outputNum,
-                                          StringRef outputRootPath) {
-  unsigned paretoNum = paretoPoints.size();
-  auto sampleStep = std::max(paretoNum / outputNum, (unsigned)1);
+LogicalResult FuncDesignSpace::exportParetoDesign(unsigned paretoIndex,
+                                                  StringRef outputRootPath,
+                                                  bool exportCpp) {
+  auto &funcPoint = paretoPoints[paretoIndex];
+  std::vector<FactorList> tileLists;
+  SmallVector<unsigned, 4> targetIIs;
+  SmallVector<bool, 4> flattens;
 
-  // Traverse all detected pareto points.
-  unsigned sampleIndex = 0;
-  for (auto &funcPoint : paretoPoints) {
-    // Only export sampled points.
-    if (sampleIndex % sampleStep == 0) {
-      std::vector<FactorList> tileLists;
-      SmallVector<unsigned, 4> targetIIs;
+  for (unsigned i = 0; i < loopDesignSpaces.size(); ++i) {
+    auto &loopSpace = loopDesignSpaces[i];
+    auto &loopPoint = funcPoint.loopDesignPoints[i];
+    auto tileList = loopSpace.getTileList(loopPoint.tileConfig);
+    auto targetII = loopPoint.targetII;
 
-      for (unsigned i = 0; i < loopDesignSpaces.size(); ++i) {
-        auto &loopSpace = loopDesignSpaces[i];
-        auto &loopPoint = funcPoint.loopDesignPoints[i];
-        auto tileList = loopSpace.getTileList(loopPoint.tileConfig);
-        auto targetII = loopPoint.targetII;
+    tileLists.push_back(tileList);
+    targetIIs.push_back(targetII);
+    flattens.push_back(loopPoint.flatten);
+  }
 
-        tileLists.push_back(tileList);
-        targetIIs.push_back(targetII);
-      }
+  // Clone a new function into a standalone module and apply optimization.
+  // The module is required for emitting HLS C++ code.
+  OwningOpRef<ModuleOp> module = ModuleOp::create(func.getLoc());
+  auto tmpFunc = func.clone();
+  module->push_back(tmpFunc);
+  if (!applyOptStrategy(tmpFunc, tileLists, targetIIs, flattens))
+    return failure();
 
-      // Clone a new function and apply optimization.
-      auto tmpFunc = func.clone();
-      if (!applyOptStrategy(tmpFunc, tileLists, targetIIs))
-        return false;
-      estimator.estimateFunc(tmpFunc);
+  // Each design point is estimated by its own estimator, as the estimator
+  // holds scheduling information and cannot be shared between threads.
+  auto pointEstimator = estimator.clone();
+  pointEstimator.estimateFunc(tmpFunc);
+  pointEstimator.materializeAttributes(tmpFunc);
 
-      // Parse a new output file.
-      auto outputFilePath = outputRootPath.str() + func.getName().str() +
-                            "_pareto_" + std::to_string(sampleIndex) + ".mlir";
+  // Parse a new output file.
+  auto outputFilePath = outputRootPath.str() + func.getName().str() +
+                        "_pareto_" + std::to_string(paretoIndex);
 
-      std::string errorMessage;
-      auto outputFile = mlir::openOutputFile(outputFilePath, &errorMessage);
-      if (!outputFile)
-        return false;
+  std::string errorMessage;
+  auto outputFile =
+      mlir::openOutputFile(outputFilePath + ".mlir", &errorMessage);
+  if (!outputFile)
+    return failure();
+  outputFile->os() << tmpFunc << "\n";
+  outputFile->keep();
+
+  if (!exportCpp)
+    return success();
+
+  auto cppFile = mlir::openOutputFile(outputFilePath + ".cpp", &errorMessage);
+  if (!cppFile || failed(emitHLSCpp(*module, cppFile->os())))
+    return failure();
+  cppFile->keep();
+  return success();
+}
 
-      auto &os = outputFile->os();
-      os << tmpFunc << "\n";
-      outputFile->keep();
-    }
-    ++sampleIndex;
-  }
+bool FuncDesignSpace::exportParetoDesigns(unsigned outputNum,
+                                          StringRef outputRootPath,
+                                          bool exportCpp) {
+  unsigned paretoNum = paretoPoints.size();
+  auto sampleStep = std::max(paretoNum / outputNum, (unsigned)1);
+
+  // Collect the indices of all sampled pareto points.
+  SmallVector<unsigned, 32> sampleIndices;
+  for (unsigned i = 0; i < paretoNum; i += sampleStep)
+    sampleIndices.push_back(i);
+
+  // Sampled points are independent with each other, thus can be optimized,
+  // estimated, and exported in parallel. The points are processed sequentially
+  // if multi-threading is disabled in the context, in which case the uniquing
+  // of types and attributes is not thread-safe. Otherwise, the dialects used by
+  // the nested pass pipelines are loaded ahead, as loading dialects during
+  // multi-threaded execution is not allowed.
+  auto context = func.getContext();
+  if (context->isMultithreadingEnabled())
+    loadMemoryOptsDialects(context);
+  if (failed(failableParallelForEach(
+          context, sampleIndices, [&](unsigned paretoIndex) {
+            return exportParetoDesign(paretoIndex, outputRootPath, exportCpp);
+          })))
+    return false;
 
-  LLVM_DEBUG(
-      llvm::dbgs() << "Sampled pareto points MLIR files are exported to path \""
-                   << outputRootPath << "\".\n\n");
+  LLVM_DEBUG(llvm::dbgs() << "Sampled pareto points "
+                          << (exportCpp ? "MLIR and C++" : "MLIR")
+                          << " files are exported to path \""
+                          << outputRootPath << "\".\n\n");
   return true;
 }
 
@@ -559,14 +629,19 @@ bool ScaleHLSExplorer::emitQoRDebugInfo(func::FuncOp func,
                                         std::string message) {
   estimator.estimateFunc(func);
   // auto latency = getTiming(func).getLatency();
-  auto dspNum = getResource(func).getDsp();
 
   LLVM_DEBUG(llvm::dbgs() << message + "\n";
              //  llvm::dbgs() << "The clock cycle is " << Twine(latency)
              //               << ", DSP usage is " << Twine(dspNum) << ".\n\n";
   );
 
-  return dspNum <= maxDspNum;
+  return meetResourceConstr(func);
+}
+
+bool ScaleHLSExplorer::meetResourceConstr(func::FuncOp func) {
+  auto resource = estimator.getResource(func);
+  return resource.getDsp() <= maxDspNum && resource.getLut() <= maxLutNum &&
+         resource.getFf() <= maxFfNum;
 }
 
 static int64_t getInnerParallelism(Block &block) {
@@ -585,6 +660,87 @@ static int64_t getInnerParallelism(Block &block) {
 
 bool ScaleHLSExplorer::evaluateFuncPipeline(func::FuncOp func) { return true; }
 
+/// Return true if the function only contains calls and memory allocations,
+/// which is required by function dataflow.
+static bool isDataflowLegal(func::FuncOp func) {
+  unsigned numCalls = 0;
+  for (auto &op : func.front()) {
+    if (isa<func::CallOp>(op))
+      ++numCalls;
+    else if (!isa<memref::AllocOp, memref::AllocaOp, BufferOp,
+                  arith::ConstantOp, func::ReturnOp>(op))
+      return false;
+  }
+  return numCalls > 1;
+}
+
+/// DSE Stage0: Explore function level directives, which is only applied when
+/// the DSE is directive-only. If the function is legal to be dataflowed, all
+/// callees are kept and the dataflow design is picked if it achieves a smaller
+/// interval than the sequential design under the resource constraints.
+/// Otherwise, each callee is inlined if the inlining doesn't increase the
+/// latency of the function and meets the resource constraints. Note that the
+/// inlined loops will be further optimized by the following stages.
+bool ScaleHLSExplorer::exploreFuncDirectives(func::FuncOp func) {
+  LLVM_DEBUG(llvm::dbgs() << "----------\nStage0: Explore function inline and "
+                             "dataflow directives...\n";);
+
+  auto module = func->getParentOfType<ModuleOp>();
+  if (!module || func.getOps<func::CallOp>().empty())
+    return emitQoRDebugInfo(func, "\nFinish Stage0.");
+
+  estimator.estimateFunc(func);
+  auto latency = estimator.getTiming(func).getLatency();
+  auto interval = estimator.getTiming(func).getInterval();
+
+  if (isDataflowLegal(func)) {
+    auto directive = getFuncDirective(func);
+    setFuncDirective(func, false, 1, true);
+    estimator.estimateFunc(func);
+
+    if (estimator.getTiming(func).getInterval() < interval &&
+        meetResourceConstr(func)) {
+      LLVM_DEBUG(llvm::dbgs() << "Apply function dataflow\n";);
+      return emitQoRDebugInfo(func, "\nFinish Stage0.");
+    }
+
+    // Restore the original function directive.
+    if (directive)
+      setFuncDirective(func, directive);
+    else
+      func->removeAttr("func_directive");
+  }
+
+  // Evaluate the inlining of each call in a temporary module. Note that the
+  // inlined callee may contain calls, which are evaluated in order as well.
+  unsigned callIndex = 0;
+  while (true) {
+    auto calls = SmallVector<func::CallOp, 8>(func.getOps<func::CallOp>());
+    if (callIndex >= calls.size())
+      break;
+
+    OwningOpRef<ModuleOp> tmpModule = module.clone();
+    auto tmpFunc = tmpModule->lookupSymbol<func::FuncOp>(func.getName());
+    auto tmpCalls =
+        SmallVector<func::CallOp, 8>(tmpFunc.getOps<func::CallOp>());
+
+    if (applyCalleeInlining(tmpCalls[callIndex])) {
+      estimator.estimateFunc(tmpFunc);
+      auto tmpLatency = estimator.getTiming(tmpFunc).getLatency();
+      auto callee = calls[callIndex].getCallee().str();
+      if (tmpLatency <= latency && meetResourceConstr(tmpFunc) &&
+          applyCalleeInlining(calls[callIndex])) {
+        LLVM_DEBUG(llvm::dbgs() << "Inline callee " << callee << "\n";);
+        latency = tmpLatency;
+        continue;
+      }
+    }
+    ++callIndex;
+  }
+
+  return emitQoRDebugInfo(func, "\nFinish Stage0.");
+}
+
 /// DSE Stage1: Simplify loop nests by unrolling. If we take the following loops
 /// as example, where each nodes represents one sequential loop nests (LN). In
 /// the simplification, we'll first try to pipeline LN1 and LN6. Suppose
@@ -677,7 +833,7 @@ bool ScaleHLSExplorer::simplifyLoopNests(func::FuncOp func) {
       estimator.estimateFunc(tmpFunc);
 
       // Fully unroll the candidate loop or delve into child loops.
-      if (getResource(tmpFunc).getDsp() <= maxDspNum) {
+      if (meetResourceConstr(tmpFunc)) {
         applyFullyLoopUnrolling(*candidate.getBody());
         applyMemoryOpts(func);
         applyAutoArrayPartition(func);
@@ -735,12 +891,20 @@ bool ScaleHLSExplorer::exploreDesignSpace(func::FuncOp func, bool directiveOnly,
   getLoopBands(tmpFunc.front(), targetBands);
   unsigned targetNum = targetBands.size();
 
+  // If there is no loop band to explore, e.g. the function is dataflowed with
+  // all callees kept, directly finish the exploration.
+  if (targetNum == 0) {
+    tmpFunc.erase();
+    return emitQoRDebugInfo(func, "\nFinish Stage3.");
+  }
+
   // Search for the pareto frontiers of each target loop band.
   SmallVector<LoopDesignSpace, 4> loopSpaces;
   for (unsigned i = 0; i < targetNum; ++i) {
     auto space =
         LoopDesignSpace(tmpFunc, targetBands[i], estimator, maxDspNum,
-                        maxExplParallel, maxLoopParallel, directiveOnly);
+                        maxExplParallel, maxLoopParallel, directiveOnly,
+                        randomSeed ? randomSeed + i : 0);
 
     LLVM_DEBUG(llvm::dbgs() << "Loop band " << i << ": ";);
     space.initializeLoopDesignSpace(maxInitParallel);
@@ -765,14 +929,15 @@ bool ScaleHLSExplorer::exploreDesignSpace(func::FuncOp func, bool directiveOnly,
       csvRootPath.str() + func.getName().str() + "_space.csv";
   funcSpace.dumpFuncDesignSpace(funcCsvFilePath);
 
-  // Export sampled pareto points MLIR source.
-  funcSpace.exportParetoDesigns(outputNum, outputRootPath);
+  // Export sampled pareto points MLIR source and, optionally, HLS C++ code.
+  funcSpace.exportParetoDesigns(outputNum, outputRootPath, exportCpp);
 
   // Apply the best function design point under the constraints.
   for (auto &funcPoint : funcSpace.paretoPoints) {
     if (funcPoint.dspNum <= maxDspNum) {
       std::vector<FactorList> tileLists;
       SmallVector<unsigned, 4> targetIIs;
+      SmallVector<bool, 4> flattens;
 
       for (unsigned i = 0; i < targetNum; ++i) {
         auto &loopSpace = funcSpace.loopDesignSpaces[i];
@@ -783,13 +948,16 @@ bool ScaleHLSExplorer::exploreDesignSpace(func::FuncOp func, bool directiveOnly,
         LLVM_DEBUG(llvm::dbgs() << "Loop band " << i << ": "
                                 << "Loop tiling & pipelining (";);
         LLVM_DEBUG(for (auto tile : tileList) { llvm::dbgs() << tile << ","; });
-        LLVM_DEBUG(llvm::dbgs() << targetII << ")\n");
+        LLVM_DEBUG(llvm::dbgs() << targetII << ")"
+                                << (loopPoint.flatten ? "" : " w/o flatten")
+                                << "\n");
 
         tileLists.push_back(tileList);
         targetIIs.push_back(targetII);
+        flattens.push_back(loopPoint.flatten);
       }
 
-      if (!applyOptStrategy(func, tileLists, targetIIs))
+      if (!applyOptStrategy(func, tileLists, targetIIs, flattens))
         return false;
       break;
     }
@@ -809,6 +977,10 @@ void ScaleHLSExplorer::applyDesignSpaceExplore(func::FuncOp func,
                                                StringRef csvRootPath) {
   emitQoRDebugInfo(func, "Start multiple level DSE.");
 
+  // Explore function inline and dataflow directives.
+  if (directiveOnly && !exploreFuncDirectives(func))
+    return;
+
   // Simplify loop nests by unrolling.
   if (!simplifyLoopNests(func))
     return;
@@ -854,6 +1026,7 @@ struct DesignSpaceExplore : public DesignSpaceExploreBase<DesignSpaceExplore> {
 
     // Collect DSE configurations.
     unsigned outputNum = configObj->getInteger("output_num").value_or(30);
+    bool exportCpp = configObj->getBoolean("export_cpp").value_or(false);
 
     unsigned maxInitParallel =
         configObj->getInteger("max_init_parallel").value_or(32);
@@ -868,28 +1041,48 @@ struct DesignSpaceExplore : public DesignSpaceExploreBase<DesignSpaceExplore> {
 
     unsigned maxIterNum = configObj->getInteger("max_iter_num").value_or(30);
     float maxDistance = configObj->getNumber("max_distance").value_or(3.0);
+    unsigned randomSeed = configObj->getInteger("random_seed").value_or(0);
 
     bool directiveOnly =
         configObj->getBoolean("directive_only").value_or(false);
     bool resourceConstr =
         configObj->getBoolean("resource_constr").value_or(true);
 
-    // Collect profiling latency and DSP usage data, where default values are
-    // based on Xilinx PYNQ-Z1 board.
+    // Collect profiling latency, DSP, LUT, FF usage, and delay data, where
+    // default values are based on Xilinx PYNQ-Z1 board.
     llvm::StringMap<int64_t> latencyMap;
     getLatencyMap(configObj, latencyMap);
     llvm::StringMap<int64_t> dspUsageMap;
     getDspUsageMap(configObj, dspUsageMap);
+    llvm::StringMap<int64_t> lutUsageMap;
+    getLutUsageMap(configObj, lutUsageMap);
+    llvm::StringMap<int64_t> ffUsageMap;
+    getFfUsageMap(configObj, ffUsageMap);
+    llvm::StringMap<int64_t> axiMap;
+    getAxiMap(configObj, axiMap);
+    llvm::StringMap<double> delayMap;
+    getDelayMap(configObj, delayMap);
+    auto clockPeriod = getClockPeriod(configObj);
 
     unsigned maxDspNum = ceil(configObj->getInteger("dsp").value_or(220) * 1.1);
-    if (!resourceConstr)
+    unsigned maxLutNum =
+        ceil(configObj->getInteger("lut").value_or(53200) * 1.1);
+    unsigned maxFfNum =
+        ceil(configObj->getInteger("ff").value_or(106400) * 1.1);
+    if (!resourceConstr) {
       maxDspNum = UINT_MAX;
+      maxLutNum = UINT_MAX;
+      maxFfNum = UINT_MAX;
+    }
 
     // Initialize an performance and resource estimator.
-    auto estimator = ScaleHLSEstimator(latencyMap, dspUsageMap, true);
-    auto explorer = ScaleHLSExplorer(estimator, outputNum, maxDspNum,
-                                     maxInitParallel, maxExplParallel,
-                                     maxLoopParallel, maxIterNum, maxDistance);
+    auto estimator =
+        ScaleHLSEstimator(latencyMap, dspUsageMap, lutUsageMap, ffUsageMap,
+                          axiMap, delayMap, clockPeriod, true);
+    auto explorer = ScaleHLSExplorer(
+        estimator, outputNum, exportCpp, maxDspNum, maxLutNum, maxFfNum,
+        maxInitParallel, maxExplParallel, maxLoopParallel, maxIterNum,
+        maxDistance, randomSeed);
 
     // Optimize the top function.
     // TODO: Support to contain sub-functions.
@@ -898,6 +1091,13 @@ struct DesignSpaceExplore : public DesignSpaceExploreBase<DesignSpaceExplore> {
         explorer.applyDesignSpaceExplore(func, directiveOnly, outputPath,
                                          csvPath);
     }
+
+    auto &depCache = estimator.getDependenceCache();
+    numDepQueries = depCache.getNumQueries();
+    numDepCacheHits = depCache.getNumHits();
+    LLVM_DEBUG(llvm::dbgs() << "Dependence cache hit rate: "
+                            << depCache.getNumHits() << "/"
+                            << depCache.getNumQueries() << "\n";);
   }
 };
 } // namespace
@@ -14,7 +14,7 @@ using namespace hls;
 /// Apply loop pipelining to the input loop, all inner loops are automatically
 /// fully unrolled.
 bool scalehls::applyLoopPipelining(AffineLoopBand &band, unsigned pipelineLoc,
-                                   unsigned targetII) {
+                                   unsigned targetII, bool flatten) {
   auto targetLoop = band[pipelineLoc];
 
   if (auto directive = getLoopDirective(targetLoop))
@@ -32,6 +32,8 @@ bool scalehls::applyLoopPipelining(AffineLoopBand &band, unsigned pipelineLoc,
   band.resize(pipelineLoc + 1);
 
   setLoopDirective(targetLoop, true, targetII, false, false);
+  if (!flatten)
+    return true;
 
   // All outer loops that perfect nest the pipelined loop can be flattened.
   auto currentLoop = targetLoop;
@@ -5,31 +5,349 @@
 //===----------------------------------------------------------------------===//
 
 #include "mlir/Dialect/Affine/Analysis/Utils.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/AsmState.h"
 #include "mlir/Support/FileUtilities.h"
 #include "scalehls/Transforms/Estimator.h"
 #include "scalehls/Transforms/Passes.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ToolOutputFile.h"
 
 using namespace std;
 using namespace mlir;
 using namespace scalehls;
 using namespace hls;
 
+//===----------------------------------------------------------------------===//
+// DependenceCache Class Definition
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Build the cache key of a dependence query. Induction variables are encoded
+/// with the position of their loops, constants are encoded with their values,
+/// and other values are encoded with the order of their first appearance.
+class DependenceKeyBuilder {
+public:
+  void addValue(Value value, ArrayRef<Operation *> enclosingOps) {
+    if (auto loop = getForInductionVarOwner(value)) {
+      auto it = llvm::find(enclosingOps, loop.getOperation());
+      if (it != enclosingOps.end()) {
+        addInt(/*tag=*/0);
+        addInt(it - enclosingOps.begin());
+        return;
+      }
+    }
+    if (auto constOp = value.getDefiningOp<arith::ConstantIndexOp>()) {
+      addInt(/*tag=*/1);
+      addInt(constOp.value());
+      return;
+    }
+    auto result = valueIds.try_emplace(value, valueIds.size());
+    addInt(/*tag=*/2);
+    addInt(result.first->second);
+  }
+
+  void addValues(ValueRange values, ArrayRef<Operation *> enclosingOps) {
+    key.push_back(values.size());
+    for (auto value : values)
+      addValue(value, enclosingOps);
+  }
+
+  void addPointer(const void *ptr) { key.push_back((intptr_t)ptr); }
+  void addInt(int64_t value) { key.push_back(value); }
+
+  /// Add the access map and all surrounding affine loops and ifs of an access.
+  void addAccess(const MemRefAccess &access,
+                 SmallVectorImpl<Operation *> &enclosingOps) {
+    getEnclosingAffineForAndIfOps(*access.opInst, &enclosingOps);
+    addInt(enclosingOps.size());
+
+    for (auto op : enclosingOps) {
+      if (auto loop = dyn_cast<AffineForOp>(op)) {
+        addPointer(loop.getLowerBoundMap().getAsOpaquePointer());
+        addValues(loop.getLowerBoundOperands(), enclosingOps);
+        addPointer(loop.getUpperBoundMap().getAsOpaquePointer());
+        addValues(loop.getUpperBoundOperands(), enclosingOps);
+        addInt(loop.getStep());
+      } else {
+        auto ifOp = cast<AffineIfOp>(op);
+        addPointer(ifOp.getIntegerSet().getAsOpaquePointer());
+        addValues(ifOp.getOperands(), enclosingOps);
+        auto region = access.opInst->getParentRegion();
+        addInt(ifOp.getThenRegion().isAncestor(region));
+      }
+    }
+
+    AffineValueMap accessMap;
+    access.getAccessMap(&accessMap);
+    addPointer(accessMap.getAffineMap().getAsOpaquePointer());
+    addValues(accessMap.getOperands(), enclosingOps);
+    addInt(isa<AffineReadOpInterface>(access.opInst));
+  }
+
+  StringRef getKey() const {
+    return StringRef((const char *)key.data(), key.size() * sizeof(int64_t));
+  }
+
+private:
+  SmallVector<int64_t, 64> key;
+  DenseMap<Value, int64_t> valueIds;
+};
+} // namespace
+
+/// Encode the relative position of the two operations, which determines the
+/// dependence at the depth deeper than the number of common loops.
+static int64_t getRelativePosition(Operation *srcOp, Operation *dstOp,
+                                   unsigned numCommonLoops) {
+  Block *commonBlock = nullptr;
+  if (numCommonLoops) {
+    AffineLoopBand srcLoops;
+    getLoopIVs(*srcOp, &srcLoops);
+    commonBlock = srcLoops[numCommonLoops - 1].getBody();
+  } else {
+    commonBlock = srcOp->getBlock();
+    while (!isa<func::FuncOp>(commonBlock->getParentOp()))
+      commonBlock = commonBlock->getParentOp()->getBlock();
+  }
+
+  auto srcAncestor = commonBlock->findAncestorOpInBlock(*srcOp);
+  auto dstAncestor = commonBlock->findAncestorOpInBlock(*dstOp);
+  if (!srcAncestor || !dstAncestor || srcAncestor == dstAncestor)
+    return 0;
+  return srcAncestor->isBeforeInBlock(dstAncestor) ? 1 : 2;
+}
+
+DependenceResult DependenceCache::checkDependence(
+    const MemRefAccess &srcAccess, const MemRefAccess &dstAccess,
+    unsigned depth, SmallVectorImpl<DependenceComponent> *depComps) {
+  ++numQueries;
+
+  // Build the cache key of the current query.
+  DependenceKeyBuilder builder;
+  SmallVector<Operation *, 8> srcOps;
+  SmallVector<Operation *, 8> dstOps;
+  builder.addAccess(srcAccess, srcOps);
+  builder.addAccess(dstAccess, dstOps);
+
+  unsigned numCommonOps = 0;
+  unsigned numCommonLoops = 0;
+  while (numCommonOps < srcOps.size() && numCommonOps < dstOps.size() &&
+         srcOps[numCommonOps] == dstOps[numCommonOps])
+    if (isa<AffineForOp>(srcOps[numCommonOps++]))
+      ++numCommonLoops;
+
+  builder.addInt(srcAccess.memref == dstAccess.memref);
+  builder.addInt(numCommonOps);
+  builder.addInt(getRelativePosition(srcAccess.opInst, dstAccess.opInst,
+                                     numCommonLoops));
+  builder.addInt(depth);
+  auto key = builder.getKey();
+
+  // Rebuild the dependence components from the cached entry, where the loop
+  // of each component is the corresponding surrounding loop of the source.
+  auto getCachedResult = [&](const Entry &entry) {
+    if (depComps) {
+      AffineLoopBand srcLoops;
+      getLoopIVs(*srcAccess.opInst, &srcLoops);
+      depComps->clear();
+      for (unsigned i = 0, e = entry.comps.size(); i < e; ++i) {
+        DependenceComponent comp;
+        comp.op = srcLoops[i];
+        comp.lb = entry.comps[i].first;
+        comp.ub = entry.comps[i].second;
+        depComps->push_back(comp);
+      }
+    }
+    return DependenceResult(entry.value);
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it != entries.end() && (!depComps || it->second.hasComps)) {
+      ++numHits;
+      return getCachedResult(it->second);
+    }
+  }
+
+  // Cache miss, conduct the dependence analysis and record the result.
+  FlatAffineValueConstraints depConstrs;
+  auto result = checkMemrefAccessDependence(srcAccess, dstAccess, depth,
+                                            &depConstrs, depComps,
+                                            /*allowRAR=*/true);
+
+  Entry entry;
+  entry.value = result.value;
+  entry.hasComps = depComps != nullptr;
+  if (depComps)
+    for (auto &comp : *depComps)
+      entry.comps.push_back({comp.lb, comp.ub});
+
+  std::lock_guard<std::mutex> lock(mutex);
+  entries[key] = entry;
+  return result;
+}
+
+//===----------------------------------------------------------------------===//
+// Operator Related Methods
+//===----------------------------------------------------------------------===//
+
+void ScaleHLSEstimator::estimateOperator(Operation *op, int64_t begin,
+                                         StringRef key, int64_t latency,
+                                         int64_t num) {
+  // Combinational operators are chained with their successors as long as the
+  // accumulated delay fits in the clock period. Otherwise, a register is
+  // inserted between the operator and its successors. Multi-cycle operators
+  // register their results, thus only their inputs can be chained.
+  auto delay = delayMap.lookup(key);
+  auto chainDelay = delay;
+  if (latency == 0) {
+    chainDelay += getSuccChainDelay(op, begin);
+    if (chainDelay > clockPeriod && chainDelay > delay) {
+      ++begin;
+      chainDelay = delay;
+    }
+  }
+  setTiming(op, begin, begin + latency, latency, 1);
+  results[op].chainDelay = chainDelay;
+
+  // Combinational operators are chained with their successors, but still
+  // occupy operator instances at their begin level.
+  for (int64_t i = 0; i < max(latency, (int64_t)1); ++i)
+    numOperatorMap[begin + i][key] += num;
+  numOperationMap[begin][key] += num;
+  totalNumOperatorMap[key] += num;
+}
+
+/// Estimate an integer operator according to its bit width, which is the
+/// widest bit width of all operands and results. Each element of a vector is
+/// considered as a separate operator.
+void ScaleHLSEstimator::estimateIntOperator(Operation *op, int64_t begin,
+                                            StringRef name) {
+  unsigned bitWidth = 1;
+  int64_t num = 1;
+  auto updateBitWidth = [&](Type type) {
+    if (auto vectorType = type.dyn_cast<VectorType>()) {
+      num = max(num, vectorType.getNumElements());
+      type = vectorType.getElementType();
+    }
+    // Index type is emitted as 32-bits integer in HLS C++.
+    if (type.isIndex())
+      bitWidth = max(bitWidth, 32u);
+    else if (type.isIntOrFloat())
+      bitWidth = max(bitWidth, type.getIntOrFloatBitWidth());
+  };
+  llvm::for_each(op->getOperandTypes(), updateBitWidth);
+  llvm::for_each(op->getResultTypes(), updateBitWidth);
+
+  auto key = getIntOperatorKey(name, bitWidth);
+  // The profiling data is shared by the estimators running in parallel, thus
+  // must not be modified during the estimation.
+  estimateOperator(op, begin, key, latencyMap.lookup(key), num);
+}
+
 //===----------------------------------------------------------------------===//
 // LoadOp and StoreOp Related Methods
 //===----------------------------------------------------------------------===//
 
+/// Return the bit width of a type, where index type is emitted as 32-bits
+/// integer in HLS C++ and shaped types are flattened.
+static int64_t getBitWidth(Type type) {
+  if (auto shapedType = type.dyn_cast<ShapedType>())
+    return shapedType.getNumElements() *
+           getBitWidth(shapedType.getElementType());
+  if (type.isIntOrFloat())
+    return type.getIntOrFloatBitWidth();
+  return 32;
+}
+
+/// Get the AXI bundle of a DRAM memref. Memrefs that are not bound to any AXI
+/// port are considered to have their own bundles.
+static Value getAxiBundle(Value memref) {
+  while (auto arg = memref.dyn_cast<BlockArgument>()) {
+    auto parentOp = arg.getOwner()->getParentOp();
+    if (!isa<NodeOp, ScheduleOp>(parentOp))
+      break;
+    memref = parentOp->getOperand(arg.getArgNumber());
+  }
+  if (auto port = memref.getDefiningOp<AxiPortOp>())
+    return port.getBundle();
+  return memref;
+}
+
+/// Return whether the memory access is consecutive along the loop, where only
+/// the innermost dimension is increased by one in each iteration. Accesses
+/// invariant to the loop are considered as consecutive as well.
+static bool isConsecutiveAccess(Operation *op, AffineForOp loop) {
+  AffineValueMap accessMap;
+  MemRefAccess(op).getAccessMap(&accessMap);
+  auto map = accessMap.getAffineMap();
+
+  for (unsigned i = 0, e = accessMap.getNumDims(); i < e; ++i) {
+    if (accessMap.getOperand(i) != loop.getInductionVar())
+      continue;
+
+    auto dim = getAffineDimExpr(i, op->getContext());
+    for (unsigned j = 0, numResults = map.getNumResults(); j < numResults;
+         ++j) {
+      auto expr = map.getResult(j);
+      auto diff = simplifyAffineExpr(
+          expr.replace(dim, dim + loop.getStep()) - expr, map.getNumDims(),
+          map.getNumSymbols());
+      auto constDiff = diff.dyn_cast<AffineConstantExpr>();
+      if (!constDiff)
+        return false;
+      if (constDiff.getValue() != 0 &&
+          (j != numResults - 1 || constDiff.getValue() != 1))
+        return false;
+    }
+  }
+  return true;
+}
+
+/// Get the innermost pipelined loop surrounding the operation.
+static AffineForOp getPipelinedLoop(Operation *op) {
+  for (auto loop = op->getParentOfType<AffineForOp>(); loop;
+       loop = loop->getParentOfType<AffineForOp>())
+    if (auto loopDirect = getLoopDirective(loop))
+      if (loopDirect.getPipeline())
+        return loop;
+  return AffineForOp();
+}
+
+/// Return whether the operation is in a pipelined loop or function, where all
+/// operations are issued in every initiation interval.
+static bool isInPipelinedRegion(Operation *op) {
+  if (getPipelinedLoop(op))
+    return true;
+  if (auto func = op->getParentOfType<func::FuncOp>())
+    if (auto funcDirect = getFuncDirective(func))
+      return funcDirect.getPipeline();
+  return false;
+}
+
+/// Return whether the DRAM access can be inferred as a burst access, which
+/// requires the access to be consecutive along its pipelined loop.
+static bool isBurstAccess(Operation *op) {
+  auto loop = getPipelinedLoop(op);
+  return loop && isConsecutiveAccess(op, loop);
+}
+
 /// Calculate the overall partition index.
 void ScaleHLSEstimator::getPartitionIndices(Operation *op) {
   auto builder = Builder(op);
+  auto &opResults = results[op];
   auto access = MemRefAccess(op);
   auto memrefType = access.memref.getType().cast<MemRefType>();
 
   // If the layout map does not exist, it means the memory is not partitioned.
   auto layoutMap = memrefType.getLayout().getAffineMap();
   if (layoutMap.isIdentity()) {
-    auto partitionIndices = SmallVector<int64_t, 8>(memrefType.getRank(), 0);
-    op->setAttr("partition_indices", builder.getI64ArrayAttr(partitionIndices));
+    opResults.partitionIndices.assign(memrefType.getRank(), 0);
+    opResults.maxMuxSize = 1;
     return;
   }
 
@@ -69,25 +387,183 @@ void ScaleHLSEstimator::getPartitionIndices(Operation *op) {
 
   // Calculate the partition index of this load/store operation honoring the
   // partition strategy applied.
-  SmallVector<int64_t, 8> partitionIndices;
-  int64_t maxMuxSize = 1;
-  bool hasUncertainIdx = false;
+  opResults.partitionIndices.clear();
+  opResults.maxMuxSize = 1;
 
   for (int64_t dim = 0; dim < memrefType.getRank(); ++dim) {
     auto idxExpr = composeMap.getResult(dim);
 
     if (auto constExpr = idxExpr.dyn_cast<AffineConstantExpr>())
-      partitionIndices.push_back(constExpr.getValue());
+      opResults.partitionIndices.push_back(constExpr.getValue());
     else {
-      partitionIndices.push_back(-1);
-      maxMuxSize = max(maxMuxSize, factors[dim]);
-      hasUncertainIdx = true;
+      opResults.partitionIndices.push_back(-1);
+      opResults.maxMuxSize = max(opResults.maxMuxSize, factors[dim]);
+    }
+  }
+}
+
+int64_t ScaleHLSEstimator::getMaxMuxSize(Operation *op) const {
+  auto it = results.find(op);
+  return it == results.end() ? 1 : it->second.maxMuxSize;
+}
+
+ScaleHLSEstimator::MemPortTable::MemPortTable(MemRefType type) {
+  numPartitions = getPartitionFactors(type, &factors);
+
+  // Initialize the number of ports of each partition according to the storage
+  // type, where the default case is BRAM_S2P.
+  auto storageType = MemoryKind(type.getMemorySpaceAsInt());
+  if (isRam1P(storageType))
+    rdwrPorts = 1;
+  else if (isRam2P(storageType))
+    rdwrPorts = 1, rdPorts = 1;
+  else if (isRamT2P(storageType))
+    rdwrPorts = 2;
+  else if (isRamS2P(storageType))
+    rdPorts = 1, wrPorts = 1;
+  else
+    rdwrPorts = 2;
+
+  numPorts = rdPorts + wrPorts + rdwrPorts;
+  numWords = (numPartitions * numPorts + 63) / 64;
+}
+
+void ScaleHLSEstimator::MemPortTable::getPartitions(
+    ArrayRef<int64_t> partitionIndices,
+    SmallVectorImpl<int64_t> &partitions) const {
+  partitions.assign(1, 0);
+  int64_t accumFactor = 1;
+
+  for (unsigned dim = 0, e = factors.size(); dim < e; ++dim) {
+    auto factor = factors[dim];
+    auto index = partitionIndices[dim];
+
+    // If the index is -1, all partitions of the current dimension will be
+    // occupied and a multiplexer will be generated in HLS.
+    if (index == -1) {
+      SmallVector<int64_t, 16> newPartitions;
+      for (auto partition : partitions)
+        for (int64_t i = 0; i < factor; ++i)
+          newPartitions.push_back(partition + i * accumFactor);
+      partitions.swap(newPartitions);
+    } else if (index >= 0 && index < factor) {
+      for (auto &partition : partitions)
+        partition += index * accumFactor;
+    } else {
+      partitions.clear();
+      return;
+    }
+    accumFactor *= factor;
+  }
+}
+
+unsigned ScaleHLSEstimator::MemPortTable::getRow(int64_t level) {
+  auto result = rows.try_emplace(level, rowReads.size());
+  if (result.second) {
+    words.resize(words.size() + numWords, 0);
+    writeWords.resize(writeWords.size() + numWords, 0);
+    rowReads.emplace_back();
+  }
+  return result.first->second;
+}
+
+int64_t ScaleHLSEstimator::MemPortTable::findFreePort(unsigned row,
+                                                      int64_t partition,
+                                                      unsigned portBegin,
+                                                      unsigned portEnd) const {
+  for (auto port = portBegin; port < portEnd; ++port) {
+    auto bit = partition * numPorts + port;
+    if (!((words[row * numWords + bit / 64] >> (bit % 64)) & 1))
+      return bit;
+  }
+  return -1;
+}
+
+bool ScaleHLSEstimator::MemPortTable::reserve(int64_t level,
+                                              const MemRefAccess &access,
+                                              ArrayRef<int64_t> partitions) {
+  auto row = getRow(level);
+  auto op = access.opInst;
+  bool isRead = isa<AffineReadOpInterface>(op);
+
+  // The rationale is as long as the current read operation has identical
+  // memory access information with any scheduled read operation, the schedule
+  // will success.
+  if (isRead)
+    for (auto rdOp : rowReads[row])
+      if (op->getBlock() == rdOp->getBlock() && access == MemRefAccess(rdOp))
+        return true;
+
+  // Find a free port for each partition before committing the reservation.
+  SmallVector<int64_t, 8> bits;
+  for (auto partition : partitions) {
+    auto bit = isRead
+                   ? findFreePort(row, partition, 0, rdPorts)
+                   : findFreePort(row, partition, rdPorts, rdPorts + wrPorts);
+    if (bit == -1)
+      bit = findFreePort(row, partition, rdPorts + wrPorts, numPorts);
+    if (bit == -1)
+      return false;
+    bits.push_back(bit);
+  }
+
+  for (auto bit : bits) {
+    words[row * numWords + bit / 64] |= (uint64_t)1 << (bit % 64);
+    if (!isRead)
+      writeWords[row * numWords + bit / 64] |= (uint64_t)1 << (bit % 64);
+  }
+  if (isRead)
+    rowReads[row].push_back(op);
+  return true;
+}
+
+int64_t
+ScaleHLSEstimator::MemPortTable::getResMinII(int64_t begin, int64_t end,
+                                             int64_t *worstPartition,
+                                             int64_t numReplicas) const {
+  // Count the reads, writes, and overall accesses of each partition, where
+  // accesses placed on read/write ports are counted as well.
+  auto rdNum = SmallVector<int64_t, 16>(numPartitions, 0);
+  auto wrNum = SmallVector<int64_t, 16>(numPartitions, 0);
+  auto totalNum = SmallVector<int64_t, 16>(numPartitions, 0);
+
+  for (auto &pair : rows) {
+    if (pair.first < begin || pair.first >= end)
+      continue;
+
+    for (unsigned w = 0; w < numWords; ++w) {
+      auto index = pair.second * numWords + w;
+      for (auto word = words[index]; word; word &= word - 1) {
+        auto offset = llvm::countTrailingZeros(word);
+        auto partition = (w * 64 + offset) / numPorts;
+
+        totalNum[partition] += numReplicas;
+        if ((writeWords[index] >> offset) & 1)
+          wrNum[partition] += numReplicas;
+        else
+          rdNum[partition] += numReplicas;
+      }
     }
   }
 
-  op->setAttr("partition_indices", builder.getI64ArrayAttr(partitionIndices));
-  if (hasUncertainIdx)
-    op->setAttr("max_mux_size", builder.getI64IntegerAttr(maxMuxSize));
+  auto ceilDiv = [](int64_t a, int64_t b) { return (a + b - 1) / b; };
+  int64_t II = 1;
+  for (int64_t idx = 0; idx < numPartitions; ++idx) {
+    // Reads are bounded by read and read/write ports, while writes are bounded
+    // by write and read/write ports.
+    auto partitionII = ceilDiv(totalNum[idx], numPorts);
+    if (rdPorts + rdwrPorts)
+      partitionII = max(partitionII, ceilDiv(rdNum[idx], rdPorts + rdwrPorts));
+    if (wrPorts + rdwrPorts)
+      partitionII = max(partitionII, ceilDiv(wrNum[idx], wrPorts + rdwrPorts));
+
+    if (partitionII > II) {
+      II = partitionII;
+      if (worstPartition)
+        *worstPartition = idx;
+    }
+  }
+  return II;
 }
 
 /// Timing load/store operation honoring the memory ports number limitation.
@@ -103,106 +579,29 @@ void ScaleHLSEstimator::estimateLoadStoreTiming(Operation *op, int64_t begin) {
     return;
   }
 
-  SmallVector<int64_t, 8> factors;
-  auto partitionNum = getPartitionFactors(memrefType, &factors);
+  // DRAM is accessed through AXI interfaces and no reservation is required.
+  // Reads that cannot be inferred as bursts are issued as separate
+  // transactions, each of which waits for the whole round trip.
   auto storageType = MemoryKind(memrefType.getMemorySpaceAsInt());
-  auto partitionIndices = getIntArrayAttrValue(op, "partition_indices");
-
-  // Try to avoid memory port violation until a legal schedule is found. Since
-  // an infinite length schedule cannot be generated, this while loop can be
-  // proofed to have an end.
-  int64_t resMinII = 1;
-  for (;; ++begin) {
-    auto &memPortInfos = memPortInfosMap[begin][memref];
-
-    // If the memory has not been occupied by the current schedule level, it
-    // should be initialized according to its storage type. Note that each
-    // partition should have one PortInfo structure, where the default case is
-    // BRAM_S2P.
-    if (memPortInfos.empty())
-      for (unsigned p = 0; p < partitionNum; ++p) {
-        MemPortInfo info;
-
-        if (isRam1P(storageType))
-          info.rdwrPort = 1;
-        else if (isRam2P(storageType))
-          info.rdwrPort = 1, info.rdPort = 1;
-        else if (isRamT2P(storageType))
-          info.rdwrPort = 2;
-        else if (isRamS2P(storageType))
-          info.rdPort = 1, info.wrPort = 1;
-        else if (isDram(storageType))
-          info.rdPort = UINT_MAX, info.wrPort = UINT_MAX;
-        else
-          info.rdwrPort = 2;
-
-        memPortInfos.push_back(info);
-      }
-
-    // Indicate whether the memory access operation is successfully scheduled in
-    // the current schedule level.
-    bool successFlag = true;
-
-    // Walk through all partitions to check whether the current partition is
-    // occupied and whether available memory ports are enough to schedule the
-    // current memory access operation.
-    for (int64_t idx = 0; idx < partitionNum; ++idx) {
-      bool isOccupied = true;
-      int64_t accumFactor = 1;
-
-      for (int64_t dim = 0; dim < memrefType.getRank(); ++dim) {
-        // If the index is -1, all ports in the current partition will be
-        // occupied and a multiplexer will be generated in HLS.
-        if (partitionIndices[dim] != -1 &&
-            idx / accumFactor % factors[dim] != partitionIndices[dim]) {
-          isOccupied = false;
-          break;
-        }
-        accumFactor *= factors[dim];
-      }
-
-      if (isOccupied) {
-        auto &info = memPortInfos[idx];
-        if (isa<AffineReadOpInterface>(op)) {
-          bool hasIdenticalAccess = false;
-          // The rationale is as long as the current read operation has
-          // identical memory access information with any scheduled read
-          // operation, the schedule will success.
-          for (auto rdAccess : info.rdAccesses) {
-            if (access == rdAccess &&
-                op->getBlock() == rdAccess.opInst->getBlock())
-              hasIdenticalAccess = true;
-          }
-
-          if (hasIdenticalAccess)
-            continue;
-
-          if (info.rdPort > 0) {
-            info.rdPort--;
-            info.rdAccesses.push_back(access);
-          } else if (info.rdwrPort > 0) {
-            info.rdwrPort--;
-            info.rdAccesses.push_back(access);
-          } else {
-            successFlag = false;
-            break;
-          }
-        } else if (isa<AffineWriteOpInterface>(op)) {
-          if (info.wrPort > 0)
-            info.wrPort--;
-          else if (info.rdwrPort > 0)
-            info.rdwrPort--;
-          else {
-            successFlag = false;
-            break;
-          }
-        }
-      }
+  if (isDram(storageType)) {
+    if (isa<AffineReadOpInterface>(op) && !isBurstAccess(op)) {
+      auto latency = axiMap.lookup("latency") + 1;
+      setTiming(op, begin, begin + latency, latency, 1);
+      return;
     }
-
-    if (successFlag)
-      break;
-    ++resMinII;
+  } else {
+    auto &table = memPortTables.try_emplace(memref, memrefType).first->second;
+
+    // Directly compute the partitions touched by the current memory access.
+    SmallVector<int64_t, 16> partitions;
+    table.getPartitions(results[op].partitionIndices, partitions);
+
+    // Try to avoid memory port violation until a legal schedule is found.
+    // Since an infinite length schedule cannot be generated, this loop can be
+    // proofed to have an end.
+    while (!table.reserve(begin, access, partitions))
+      ++begin;
+    reservationLog.push_back({op, begin});
   }
 
   if (isa<AffineReadOpInterface>(op))
@@ -215,13 +614,6 @@ void ScaleHLSEstimator::estimateLoadStoreTiming(Operation *op, int64_t begin) {
 // AffineForOp Related Methods
 //===----------------------------------------------------------------------===//
 
-static int64_t getMaxMuxSize(Operation *op) {
-  if (auto maxMuxSize = op->getAttrOfType<IntegerAttr>("max_mux_size"))
-    return maxMuxSize.getInt();
-  else
-    return 1;
-}
-
 static bool isNoTouch(Operation *op) {
   if (auto noTouch = op->getAttrOfType<BoolAttr>("no_touch"))
     if (noTouch.getValue())
@@ -230,51 +622,147 @@ static bool isNoTouch(Operation *op) {
   return false;
 }
 
+/// Record the bottleneck if the given II is larger than the II required by the
+/// current bottleneck.
+static void updateBottleneck(EstimatedIIBottleneck *bottleneck,
+                             EstimatedIIBottleneck::Kind kind, int64_t II,
+                             Operation *srcOp, Operation *dstOp = nullptr,
+                             int64_t partition = -1, int64_t distance = 0) {
+  if (!bottleneck || II <= bottleneck->II)
+    return;
+  bottleneck->kind = kind;
+  bottleneck->II = II;
+  bottleneck->srcOp = srcOp;
+  bottleneck->dstOp = dstOp;
+  bottleneck->partition = partition;
+  bottleneck->distance = distance;
+}
+
 int64_t ScaleHLSEstimator::getResMinII(int64_t begin, int64_t end,
-                                       MemAccessesMap &map) {
+                                       MemAccessesMap &map,
+                                       EstimatedIIBottleneck *bottleneck) {
   int64_t II = 1;
   for (auto &pair : map) {
-    auto memref = pair.first;
+    // Note that DRAM and single-element memories don't have reservation
+    // tables. The bandwidth of DRAM is modeled by getAxiMinII() instead.
+    auto it = memPortTables.find(pair.first);
+    if (it == memPortTables.end())
+      continue;
+
+    int64_t partition = 0;
+    auto memrefII = it->second.getResMinII(begin, end, &partition);
+    II = max(II, memrefII);
+    updateBottleneck(bottleneck, EstimatedIIBottleneck::Kind::Resource,
+                     memrefII, pair.second.front(), nullptr, partition);
+  }
+  return II;
+}
+
+/// Calculate the minimum II constrained by stream channels, each of which can
+/// only be read or written once in each cycle.
+static int64_t getStreamMinII(Block &block,
+                              EstimatedIIBottleneck *bottleneck = nullptr) {
+  DenseMap<Value, int64_t> numReads;
+  DenseMap<Value, int64_t> numWrites;
+  int64_t II = 1;
+  block.walk([&](Operation *op) {
+    int64_t channelII;
+    if (auto read = dyn_cast<StreamReadOp>(op))
+      channelII = ++numReads[read.getChannel()];
+    else if (auto write = dyn_cast<StreamWriteOp>(op))
+      channelII = ++numWrites[write.getChannel()];
+    else
+      return;
+    II = max(II, channelII);
+    updateBottleneck(bottleneck, EstimatedIIBottleneck::Kind::Stream,
+                     channelII, op);
+  });
+  return II;
+}
+
+/// Calculate the minimum II constrained by the bandwidth of AXI interfaces,
+/// and the latency of burst transactions issued by the pipelined loop.
+int64_t ScaleHLSEstimator::getAxiMinII(AffineForOp loop,
+                                       int64_t &burstLatency,
+                                       EstimatedIIBottleneck *bottleneck) {
+  auto portWidth = max(axiMap.lookup("port_width"), (int64_t)1);
+  auto maxBurstLength = max(axiMap.lookup("max_burst_length"), (int64_t)1);
+  auto numOutstanding = max(axiMap.lookup("num_outstanding"), (int64_t)1);
+  auto latency = max(axiMap.lookup("latency"), (int64_t)1);
+
+  // Collect the bits transferred with bursts and the number of single
+  // transactions of each bundle in one iteration. Read and write channels are
+  // independent with each other.
+  struct AxiTraffic {
+    int64_t burstBits = 0;
+    int64_t numSingles = 0;
+    Operation *firstOp = nullptr;
+  };
+  DenseMap<Value, AxiTraffic> reads;
+  DenseMap<Value, AxiTraffic> writes;
+  burstLatency = 0;
+
+  loop.walk([&](Operation *op) {
+    if (!isa<AffineReadOpInterface, AffineWriteOpInterface>(op))
+      return;
+    auto memref = MemRefAccess(op).memref;
     auto memrefType = memref.getType().cast<MemRefType>();
-    auto partitionNum = getPartitionFactors(memrefType);
-    auto storageType = MemoryKind(memrefType.getMemorySpaceAsInt());
+    if (!isDram(MemoryKind(memrefType.getMemorySpaceAsInt())))
+      return;
+
+    auto bundle = getAxiBundle(memref);
+    auto &traffic = isa<AffineReadOpInterface>(op) ? reads[bundle]
+                                                   : writes[bundle];
+    if (!traffic.firstOp)
+      traffic.firstOp = op;
+    if (isConsecutiveAccess(op, loop)) {
+      traffic.burstBits += getBitWidth(memrefType.getElementType());
+      burstLatency = latency;
+    } else
+      ++traffic.numSingles;
+  });
 
-    // FIXME: Study how Vivado HLS handle AXI interfaces.
-    if (isDram(storageType))
-      continue;
+  // Each channel transfers at most one beat in each cycle. Meanwhile, the
+  // sustained bandwidth is limited by the number of outstanding transactions,
+  // each of which holds a burst or a single beat.
+  auto burstRate = min(1.0, (double)numOutstanding * maxBurstLength / latency);
+  auto singleRate = min(1.0, (double)numOutstanding / latency);
 
-    auto accessNum = SmallVector<int64_t, 16>(partitionNum, 0);
-    // Prepare for BRAM_S1P memory kind.
-    auto writeNum = SmallVector<int64_t, 16>(partitionNum, 0);
-
-    // TODO: fine-tune for BRAM_T2P.
-    for (int64_t level = begin; level < end; ++level)
-      if (memPortInfosMap.count(level))
-        if (memPortInfosMap[level].count(memref)) {
-          auto &memPortInfos = memPortInfosMap[level][memref];
-
-          for (int64_t idx = 0; idx < partitionNum; ++idx) {
-            auto &info = memPortInfos[idx];
-            if (isRam1P(storageType) && info.rdwrPort < 1)
-              ++accessNum[idx];
-            else if (isRamT2P(storageType) && info.rdwrPort < 2)
-              ++accessNum[idx];
-            else if (info.rdPort < 1)
-              ++accessNum[idx];
-            else if (info.wrPort < 1)
-              ++writeNum[idx];
-          }
-        }
+  int64_t II = 1;
+  for (auto traffics : {&reads, &writes})
+    for (auto &bundleAndTraffic : *traffics) {
+      auto &traffic = bundleAndTraffic.second;
+      auto cycles = (double)traffic.burstBits / portWidth / burstRate +
+                    traffic.numSingles / singleRate;
+      auto bundleII = (int64_t)std::ceil(cycles);
+      II = max(II, bundleII);
+      updateBottleneck(bottleneck, EstimatedIIBottleneck::Kind::Axi, bundleII,
+                       traffic.firstOp);
+    }
+  return II;
+}
 
-    II = max({II, *std::max_element(writeNum.begin(), writeNum.end()),
-              *std::max_element(accessNum.begin(), accessNum.end())});
-  }
+/// Calculate the minimum II constrained by the sub-functions called in the
+/// pipelined block. Each call is implemented as a separate sub-pipeline, which
+/// can only accept new inputs once its own interval is passed.
+int64_t ScaleHLSEstimator::getCallMinII(Block &block,
+                                        EstimatedIIBottleneck *bottleneck) {
+  int64_t II = 1;
+  block.walk([&](func::CallOp call) {
+    if (auto timing = getTiming(call)) {
+      auto callII = max(timing.getInterval(), (int64_t)1);
+      II = max(II, callII);
+      updateBottleneck(bottleneck, EstimatedIIBottleneck::Kind::Call, callII,
+                       call);
+    }
+  });
   return II;
 }
 
 /// Calculate the minimum dependency II of function.
 int64_t ScaleHLSEstimator::getDepMinII(int64_t II, func::FuncOp func,
-                                       MemAccessesMap &map) {
+                                       MemAccessesMap &map,
+                                       EstimatedIIBottleneck *bottleneck) {
   for (auto &pair : map) {
     auto loadStores = pair.second;
 
@@ -299,8 +787,12 @@ int64_t ScaleHLSEstimator::getDepMinII(int64_t II, func::FuncOp func,
 
         // Distance is always 1 thus the minimum II is equal to delay.
         // TODO: need more case study.
-        if (MemRefAccess(srcOp) == MemRefAccess(dstOp))
+        if (MemRefAccess(srcOp) == MemRefAccess(dstOp)) {
           II = max(II, delay);
+          updateBottleneck(bottleneck,
+                           EstimatedIIBottleneck::Kind::Dependence, delay,
+                           srcOp, dstOp, -1, 1);
+        }
       }
   }
   return II;
@@ -308,7 +800,8 @@ int64_t ScaleHLSEstimator::getDepMinII(int64_t II, func::FuncOp func,
 
 /// Calculate the minimum dependency II of loop.
 int64_t ScaleHLSEstimator::getDepMinII(int64_t II, AffineForOp forOp,
-                                       MemAccessesMap &map) {
+                                       MemAccessesMap &map,
+                                       EstimatedIIBottleneck *bottleneck) {
   AffineLoopBand band;
   getLoopIVs(forOp.front(), &band);
 
@@ -358,12 +851,9 @@ int64_t ScaleHLSEstimator::getDepMinII(int64_t II, AffineForOp forOp,
           continue;
 
         for (auto depth : loopDepths) {
-          FlatAffineValueConstraints depConstrs;
           SmallVector<DependenceComponent, 2> depComps;
-
-          DependenceResult result = checkMemrefAccessDependence(
-              srcAccess, dstAccess, depth, &depConstrs, &depComps,
-              /*allowRAR=*/true);
+          DependenceResult result = depCache->checkDependence(
+              srcAccess, dstAccess, depth, &depComps);
 
           if (hasDependence(result)) {
             int64_t distance = 0;
@@ -402,6 +892,9 @@ int64_t ScaleHLSEstimator::getDepMinII(int64_t II, AffineForOp forOp,
             if (distance > 0) {
               int64_t minII = std::ceil((float)delay / distance);
               II = max(II, minII);
+              updateBottleneck(bottleneck,
+                               EstimatedIIBottleneck::Kind::Dependence, minII,
+                               srcOp, dstOp, -1, distance);
             }
           }
         }
@@ -411,16 +904,342 @@ int64_t ScaleHLSEstimator::getDepMinII(int64_t II, AffineForOp forOp,
   return II;
 }
 
+/// Return whether the attribute holds the estimation results materialized by
+/// the estimator, which are not inputs of the estimation unless the operation
+/// is marked as no_touch.
+static bool isMaterializedAttr(StringRef name) {
+  return name == "timing" || name == "resource" || name == "loop_info" ||
+         name == "partition_indices" || name == "max_mux_size";
+}
+
+/// Encode the attributes of an operation into the key. Materialized attributes
+/// are skipped unless the operation is marked as no_touch.
+static void addAttrsToKey(Operation *op, SmallVectorImpl<int64_t> &key) {
+  if (isNoTouch(op))
+    key.push_back((intptr_t)op->getAttrDictionary().getAsOpaquePointer());
+  else
+    for (auto attr : op->getAttrs())
+      if (!isMaterializedAttr(attr.getName())) {
+        key.push_back((intptr_t)attr.getName().getAsOpaquePointer());
+        key.push_back((intptr_t)attr.getValue().getAsOpaquePointer());
+      }
+  key.push_back(/*tag=*/-1);
+}
+
+/// Build the structure key of an operation, which encodes all operations nested
+/// in the operation in pre-order. Values defined in the operation are encoded
+/// with the order of their definition, and values defined outside are encoded
+/// with the order of their first appearance. The nested operations are
+/// collected into "ops". If "callees" is nullptr, return false once a call is
+/// found; otherwise, the hash of the key of each called function is encoded
+/// into the key as well, where "callees" holds the functions being encoded.
+static bool getStructureKey(Operation *root, SmallVectorImpl<int64_t> &key,
+                            SmallVectorImpl<Operation *> &ops,
+                            SmallPtrSetImpl<Operation *> *callees = nullptr) {
+  DenseMap<Value, int64_t> valueIds;
+  DenseMap<Value, int64_t> outerValueIds;
+  DenseMap<Operation *, int64_t> calleeHashes;
+
+  auto addType = [&](Type type) {
+    key.push_back((intptr_t)type.getAsOpaquePointer());
+  };
+  auto defineValue = [&](Value value) {
+    valueIds.try_emplace(value, valueIds.size());
+    addType(value.getType());
+  };
+  auto getOuterValueId = [&](Value value) {
+    return outerValueIds.try_emplace(value, outerValueIds.size())
+        .first->second;
+  };
+
+  // Return the hash of the key of the called function, or llvm::None if the
+  // key can't be built, e.g., the function is recursively called.
+  auto getCalleeHash = [&](func::CallOp call) -> Optional<int64_t> {
+    auto callee = SymbolTable::lookupNearestSymbolFrom<func::FuncOp>(
+        call, call.getCalleeAttr());
+    if (!callee || callee.isExternal())
+      return llvm::None;
+    auto it = calleeHashes.find(callee);
+    if (it != calleeHashes.end())
+      return it->second;
+    if (!callees->insert(callee).second)
+      return llvm::None;
+
+    SmallVector<int64_t, 256> calleeKey;
+    SmallVector<Operation *, 64> calleeOps;
+    auto succeeded = getStructureKey(callee, calleeKey, calleeOps, callees);
+    callees->erase(callee);
+    if (!succeeded)
+      return llvm::None;
+    auto hash = (int64_t)llvm::hash_combine_range(calleeKey.begin(),
+                                                  calleeKey.end());
+    calleeHashes[callee] = hash;
+    return hash;
+  };
+
+  auto walkResult = root->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    ops.push_back(op);
+    if (auto call = dyn_cast<func::CallOp>(op)) {
+      auto calleeHash = callees ? getCalleeHash(call) : llvm::None;
+      if (!calleeHash)
+        return WalkResult::interrupt();
+      key.push_back(*calleeHash);
+    }
+
+    key.push_back((intptr_t)op->getName().getAsOpaquePointer());
+    addAttrsToKey(op, key);
+
+    key.push_back(op->getNumOperands());
+    for (auto operand : op->getOperands()) {
+      auto it = valueIds.find(operand);
+      if (it != valueIds.end()) {
+        key.push_back(/*tag=*/0);
+        key.push_back(it->second);
+      } else if (auto constant = getConstantIntValue(operand)) {
+        // Outer constants impact the estimation with their values, e.g., the
+        // trip counts of loops and the partitions accessed by memory ops.
+        key.push_back(/*tag=*/2);
+        key.push_back(*constant);
+        addType(operand.getType());
+      } else {
+        key.push_back(/*tag=*/1);
+        key.push_back(getOuterValueId(operand));
+        addType(operand.getType());
+
+        // Memrefs sharing the same AXI bundle share the bandwidth of the bundle
+        // as well, thus the bundle assignment is encoded.
+        auto bundle = getAxiBundle(operand);
+        if (bundle != operand) {
+          key.push_back(getOuterValueId(bundle));
+          if (auto bundleOp = bundle.getDefiningOp())
+            addAttrsToKey(bundleOp, key);
+        } else
+          key.push_back(/*tag=*/-1);
+      }
+    }
+
+    key.push_back(op->getNumResults());
+    for (auto result : op->getResults())
+      defineValue(result);
+
+    key.push_back(op->getNumRegions());
+    for (auto &region : op->getRegions()) {
+      key.push_back(region.getBlocks().size());
+      for (auto &block : region) {
+        key.push_back(block.getNumArguments());
+        for (auto arg : block.getArguments())
+          defineValue(arg);
+      }
+    }
+    return WalkResult::advance();
+  });
+  return !walkResult.wasInterrupted();
+}
+
+/// Build the key of an outermost loop, whose schedule can be reused if the key
+/// is not changed. Return false if the schedule of the loop cannot be reused,
+/// as the estimation of callees is not recorded by the loop schedule. The
+/// directive and interface attributes of the parent function are encoded as
+/// well, which impact the schedule of the loop.
+static bool getLoopScheduleKey(AffineForOp loop, SmallVectorImpl<int64_t> &key,
+                               SmallVectorImpl<Operation *> &ops) {
+  if (!getStructureKey(loop, key, ops))
+    return false;
+  addAttrsToKey(loop->getParentOp(), key);
+  return true;
+}
+
+void ScaleHLSEstimator::recordResults(RecordedResults &recorded,
+                                      ArrayRef<Operation *> ops,
+                                      int64_t begin) {
+  DenseMap<Operation *, unsigned> opIndices;
+  for (unsigned i = 0, e = ops.size(); i < e; ++i)
+    opIndices[ops[i]] = i;
+
+  auto getOpIndex = [&](Operation *op) -> int64_t {
+    auto it = opIndices.find(op);
+    return it == opIndices.end() ? -1 : it->second;
+  };
+
+  for (unsigned i = 0, e = ops.size(); i < e; ++i) {
+    auto it = results.find(ops[i]);
+    if (it == results.end())
+      continue;
+
+    auto opResults = it->second;
+    if (auto &timing = opResults.timing) {
+      timing.begin -= begin;
+      timing.end -= begin;
+    }
+    if (auto &bottleneck = opResults.bottleneck)
+      recorded.bottleneckOps.push_back(
+          {i, getOpIndex(bottleneck.srcOp), getOpIndex(bottleneck.dstOp)});
+    recorded.results.push_back({i, opResults});
+  }
+}
+
+void ScaleHLSEstimator::recordLoopSchedule(LoopSchedule &schedule,
+                                           ArrayRef<Operation *> ops,
+                                           int64_t begin, unsigned logBegin) {
+  recordResults(schedule, ops, begin);
+
+  DenseMap<Operation *, unsigned> opIndices;
+  for (unsigned i = 0, e = ops.size(); i < e; ++i)
+    opIndices[ops[i]] = i;
+
+  // All operators and reservations of the loop are located in between the
+  // begin and end level of the loop.
+  auto end = getTiming(ops.front()).getEnd();
+  for (auto &level : numOperatorMap)
+    if (level.first >= begin && level.first < end)
+      schedule.numOperators.push_back({level.first - begin, level.second});
+  for (auto &level : numOperationMap)
+    if (level.first >= begin && level.first < end)
+      schedule.numOperations.push_back({level.first - begin, level.second});
+
+  for (auto i = logBegin, e = (unsigned)reservationLog.size(); i < e; ++i) {
+    auto &opAndLevel = reservationLog[i];
+    schedule.reservations.push_back(
+        {opIndices.lookup(opAndLevel.first), opAndLevel.second - begin});
+  }
+  schedule.totalNumOperators = totalNumOperatorMap;
+}
+
+void ScaleHLSEstimator::replayResults(const RecordedResults &recorded,
+                                      ArrayRef<Operation *> ops,
+                                      int64_t begin) {
+  for (auto &indexAndResults : recorded.results) {
+    auto opResults = indexAndResults.second;
+    if (auto &timing = opResults.timing) {
+      timing.begin += begin;
+      timing.end += begin;
+    }
+    results[ops[indexAndResults.first]] = opResults;
+  }
+
+  // The accesses referred by II bottlenecks are remapped to the replayed loop.
+  for (auto &indices : recorded.bottleneckOps) {
+    auto &bottleneck = results[ops[std::get<0>(indices)]].bottleneck;
+    auto srcIndex = std::get<1>(indices);
+    auto dstIndex = std::get<2>(indices);
+    bottleneck.srcOp = srcIndex == -1 ? nullptr : ops[srcIndex];
+    bottleneck.dstOp = dstIndex == -1 ? nullptr : ops[dstIndex];
+  }
+}
+
+bool ScaleHLSEstimator::replayLoopSchedule(const LoopSchedule &schedule,
+                                           ArrayRef<Operation *> ops,
+                                           int64_t begin) {
+  // Replay the memory port reservations first, which may fail if the ports are
+  // occupied in a way not captured by the key. In that case, all touched
+  // tables are restored and nothing is replayed.
+  DenseMap<Value, Optional<MemPortTable>> snapshots;
+  SmallVector<std::pair<Operation *, int64_t>, 16> reservations;
+  for (auto &indexAndLevel : schedule.reservations) {
+    auto op = ops[indexAndLevel.first];
+    auto level = indexAndLevel.second + begin;
+    auto access = MemRefAccess(op);
+    auto memrefType = access.memref.getType().cast<MemRefType>();
+
+    auto tableIt = memPortTables.find(access.memref);
+    if (!snapshots.count(access.memref))
+      snapshots[access.memref] =
+          tableIt == memPortTables.end()
+              ? Optional<MemPortTable>()
+              : Optional<MemPortTable>(tableIt->second);
+    auto &table =
+        memPortTables.try_emplace(access.memref, memrefType).first->second;
+
+    // The recorded results are sorted by the walk position of operations.
+    auto resultsIt = llvm::partition_point(
+        schedule.results,
+        [&](auto &indexAndResults) {
+          return indexAndResults.first < indexAndLevel.first;
+        });
+    assert(resultsIt != schedule.results.end() &&
+           resultsIt->first == indexAndLevel.first &&
+           "missing results of a reserving operation");
+
+    SmallVector<int64_t, 16> partitions;
+    table.getPartitions(resultsIt->second.partitionIndices, partitions);
+    if (!table.reserve(level, access, partitions)) {
+      for (auto &memrefAndSnapshot : snapshots) {
+        if (memrefAndSnapshot.second)
+          memPortTables.find(memrefAndSnapshot.first)->second =
+              *memrefAndSnapshot.second;
+        else
+          memPortTables.erase(memrefAndSnapshot.first);
+      }
+      return false;
+    }
+    reservations.push_back({op, level});
+  }
+  reservationLog.insert(reservationLog.end(), reservations.begin(),
+                        reservations.end());
+
+  replayResults(schedule, ops, begin);
+
+  for (auto &level : schedule.numOperators) {
+    auto &levelNumOperators = numOperatorMap[level.first + begin];
+    for (auto &nameAndNum : level.second)
+      levelNumOperators[nameAndNum.first()] += nameAndNum.second;
+  }
+  for (auto &level : schedule.numOperations) {
+    auto &levelNumOperations = numOperationMap[level.first + begin];
+    for (auto &nameAndNum : level.second)
+      levelNumOperations[nameAndNum.first()] += nameAndNum.second;
+  }
+  totalNumOperatorMap = schedule.totalNumOperators;
+  return true;
+}
+
 bool ScaleHLSEstimator::visitOp(AffineForOp op, int64_t begin) {
+  // Only the schedules of outermost loops are recorded and reused, because
+  // they are not impacted by any other operations except the begin level.
+  SmallVector<int64_t, 64> key;
+  SmallVector<Operation *, 64> ops;
+  if (!isa<func::FuncOp>(op->getParentOp()) || isNoTouch(op) ||
+      !getLoopScheduleKey(op, key, ops))
+    return scheduleLoop(op, begin);
+  auto keyRef =
+      StringRef((const char *)key.data(), key.size() * sizeof(int64_t));
+
+  // Reuse the schedule if the loop is not changed since the last estimation.
+  ++numLoopScheduleQueries;
+  auto it = loopSchedules.find(keyRef);
+  if (it == loopSchedules.end()) {
+    auto lastIt = lastLoopSchedules.find(keyRef);
+    if (lastIt != lastLoopSchedules.end())
+      it = loopSchedules.try_emplace(keyRef, std::move(lastIt->second)).first;
+  }
+  if (it != loopSchedules.end()) {
+    if (replayLoopSchedule(it->second, ops, begin)) {
+      ++numLoopScheduleHits;
+      return true;
+    }
+    // Fall back to a real schedule if the schedule can't be replayed.
+    it->second = LoopSchedule();
+  }
+
+  auto logBegin = reservationLog.size();
+  if (!scheduleLoop(op, begin))
+    return false;
+  recordLoopSchedule(loopSchedules[keyRef], ops, begin, logBegin);
+  return true;
+}
+
+bool ScaleHLSEstimator::scheduleLoop(AffineForOp op, int64_t begin) {
   // If a loop is marked as no_touch, then directly infer the schedule_end with
   // the exist latency.
   if (isNoTouch(op)) {
-    auto timing = getTiming(op);
-    auto resource = getResource(op);
+    auto timing = hls::getTiming(op);
+    auto resource = hls::getResource(op);
 
     if (timing && resource) {
       auto latency = timing.getLatency();
       setTiming(op, begin, begin + latency, latency, latency);
+      setResource(op, EstimatedResource(resource.getLut(), resource.getDsp(),
+                                        resource.getBram(), resource.getFf()));
       return true;
     }
   }
@@ -448,23 +1267,35 @@ bool ScaleHLSEstimator::visitOp(AffineForOp op, int64_t begin) {
     if (loopDirect.getPipeline()) {
       // Collect load and store operations in the loop block for solving
       // possible carried dependencies.
-      // TODO: include CallOps, how? It seems dependencies always exist for all
-      // CallOps not matter its access pattern.
+      // TODO: include the memory accesses of CallOps. For now, calls only
+      // constrain the II with their own intervals.
       MemAccessesMap map;
       getMemAccessesMap(loopBlock, map);
 
-      // Calculate initial interval.
+      // Calculate initial interval, and record the limiting cause of it.
       auto targetII = loopDirect.getTargetII();
-      auto resII = getResMinII(begin, end, map);
-      auto depII = getDepMinII(max(targetII, resII), op, map);
+      EstimatedIIBottleneck bottleneck;
+      updateBottleneck(&bottleneck, EstimatedIIBottleneck::Kind::Target,
+                       targetII, nullptr);
+
+      int64_t burstLatency = 0;
+      auto resII = max({getResMinII(begin, end, map, &bottleneck),
+                        getStreamMinII(loopBlock, &bottleneck),
+                        getAxiMinII(op, burstLatency, &bottleneck),
+                        getCallMinII(loopBlock, &bottleneck)});
+      auto depII = getDepMinII(max(targetII, resII), op, map, &bottleneck);
       auto II = max({targetII, resII, depII});
+      results[op].bottleneck = bottleneck;
 
       // Calculate latency of each iteration and update loop information.
       auto iterLatency = end - begin;
       setLoopInfo(op, tripCount, iterLatency, II);
 
-      // Entering and leaving a loop will consume extra 2 clock cycles.
-      auto latency = iterLatency + II * (tripCount - 1) + 2;
+      // Entering and leaving a loop will consume extra clock cycles. Burst
+      // transactions are issued ahead of the pipeline, whose latency is only
+      // exposed once.
+      auto latency = iterLatency + II * (tripCount - 1) +
+                     latencyMap.lookup("pipeline_overhead") + burstLatency;
       setTiming(op, begin, begin + latency, latency, latency);
 
       // Once the loop is pipelined, the resource sharing scheme is different.
@@ -493,34 +1324,219 @@ bool ScaleHLSEstimator::visitOp(AffineForOp op, int64_t begin) {
       auto flattenTripCount = childLoopInfo.getFlattenTripCount() * tripCount;
       auto II = childLoopInfo.getMinII();
       setLoopInfo(op, flattenTripCount, iterLatency, II);
+      results[op].bottleneck = getIIBottleneck(child);
 
-      auto latency = iterLatency + II * (flattenTripCount - 1) + 2;
+      auto latency = iterLatency + II * (flattenTripCount - 1) +
+                     latencyMap.lookup("pipeline_overhead");
       setTiming(op, begin, begin + latency, latency, latency);
       return true;
     }
   }
 
   // Default case (not flattend or pipelined), calculate latency and resource
-  // utilization accordingly.
-  auto iterLatency = end - begin;
+  // utilization accordingly. Dataflow schedules in the loop body are overlapped
+  // across iterations, thus the loop is initiated at their steady-state
+  // interval.
+  auto iterLatency = end - begin + latencyMap.lookup("loop_iter_overhead");
+  auto II = iterLatency;
+  int64_t dataflowII = 0;
+  for (auto schedule : op.getOps<ScheduleOp>())
+    dataflowII = max(dataflowII, getTiming(schedule).getInterval());
+  if (dataflowII)
+    II = min(II, dataflowII);
+  setLoopInfo(op, tripCount, iterLatency, II);
+
+  auto latency = iterLatency + II * (tripCount - 1) +
+                 latencyMap.lookup("loop_overhead");
+  setTiming(op, begin, begin + latency, latency, latency);
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// SCF and Parallel Loop Related Methods
+//===----------------------------------------------------------------------===//
+
+/// Get the constant upper bound of a loop bound value if possible, which is
+/// either a constant or the minimum of a constant and other values.
+static Optional<int64_t> getConstantUpperBound(Value value) {
+  if (auto constValue = getConstantIntValue(value))
+    return constValue;
+
+  Optional<int64_t> bound;
+  auto updateBound = [&](Optional<int64_t> candidate) {
+    if (candidate && (!bound || candidate.value() < bound.value()))
+      bound = candidate;
+  };
+  if (auto minOp = value.getDefiningOp<AffineMinOp>()) {
+    for (auto expr : minOp.getAffineMap().getResults())
+      if (auto constExpr = expr.dyn_cast<AffineConstantExpr>())
+        updateBound(constExpr.getValue());
+  } else if (auto minOp = value.getDefiningOp<arith::MinSIOp>()) {
+    updateBound(getConstantIntValue(minOp.getLhs()));
+    updateBound(getConstantIntValue(minOp.getRhs()));
+  } else if (auto minOp = value.getDefiningOp<arith::MinUIOp>()) {
+    updateBound(getConstantIntValue(minOp.getLhs()));
+    updateBound(getConstantIntValue(minOp.getRhs()));
+  }
+  return bound;
+}
+
+/// Get the trip count of a loop dimension if all bounds are constant.
+static Optional<int64_t> getTripCount(Optional<int64_t> lowerBound,
+                                      Optional<int64_t> upperBound,
+                                      Optional<int64_t> step) {
+  if (!lowerBound || !upperBound || !step || step.value() <= 0)
+    return Optional<int64_t>();
+  auto range = upperBound.value() - lowerBound.value();
+  return range > 0 ? (range + step.value() - 1) / step.value() : 0;
+}
+
+/// Get the trip count of a scf.for loop. Constant loop bounds are used if
+/// possible, otherwise the profiled trip count is used. If neither of them is
+/// available, the trip count is bounded by the constant upper bound.
+static Optional<int64_t> getScfTripCount(scf::ForOp loop) {
+  auto lowerBound = getConstantIntValue(loop.getLowerBound());
+  auto step = getConstantIntValue(loop.getStep());
+  if (auto tripCount = getTripCount(
+          lowerBound, getConstantIntValue(loop.getUpperBound()), step))
+    return tripCount;
+
+  if (auto tripCount = getProfiledTripCount(loop))
+    return tripCount;
+
+  return getTripCount(lowerBound, getConstantUpperBound(loop.getUpperBound()),
+                      step);
+}
+
+/// Schedule a sequential loop whose blocks are executed one after another in
+/// each iteration. As loop-carried dependencies are not analyzed, iterations
+/// are never overlapped.
+bool ScaleHLSEstimator::scheduleSeqLoop(Operation *op, ArrayRef<Block *> blocks,
+                                        int64_t tripCount, int64_t begin) {
+  // Blocks are scheduled reversely as well.
+  auto end = begin;
+  for (auto block : llvm::reverse(blocks)) {
+    auto timing = estimateBlock(*block, end);
+    if (!timing)
+      return false;
+    end = max(end, timing.getEnd());
+  }
+
+  auto iterLatency = end - begin + latencyMap.lookup("loop_iter_overhead");
   setLoopInfo(op, tripCount, iterLatency, iterLatency);
 
-  auto latency = iterLatency * tripCount + 2;
+  auto latency = iterLatency * tripCount + latencyMap.lookup("loop_overhead");
   setTiming(op, begin, begin + latency, latency, latency);
   return true;
 }
 
+/// Schedule a parallel loop, which is fully unrolled into replicas of the loop
+/// body. All replicas are issued at once, while they compete for the memory
+/// ports accessed in the loop body. The operators of the loop body are
+/// replicated as well.
+bool ScaleHLSEstimator::scheduleParallelLoop(Operation *op, Block &body,
+                                             int64_t tripCount,
+                                             int64_t begin) {
+  auto timing = estimateBlock(body, begin);
+  if (!timing)
+    return false;
+  auto end = timing.getEnd();
+
+  // Calculate the extra cycles required to issue the memory accesses of all
+  // replicas compared to a single replica.
+  MemAccessesMap map;
+  getMemAccessesMap(body, map);
+  int64_t extraCycles = 0;
+  for (auto &pair : map) {
+    auto it = memPortTables.find(pair.first);
+    if (it == memPortTables.end())
+      continue;
+    auto &table = it->second;
+    extraCycles = max(extraCycles,
+                      table.getResMinII(begin, end, nullptr, tripCount) -
+                          table.getResMinII(begin, end));
+  }
+
+  auto iterLatency = end - begin;
+  auto II = tripCount > 1 ? (extraCycles + tripCount - 2) / (tripCount - 1) : 0;
+  setLoopInfo(op, tripCount, iterLatency, II);
+
+  auto latency = iterLatency + extraCycles;
+  setTiming(op, begin, begin + latency, latency, latency);
+
+  // Replicate the operators and operations of the loop body.
+  for (auto numMap : {&numOperatorMap, &numOperationMap})
+    for (auto &level : *numMap)
+      if (level.first >= begin && level.first < end)
+        for (auto &nameAndNum : level.second)
+          nameAndNum.second *= tripCount;
+  for (auto &nameAndNum : totalNumOperatorMap)
+    nameAndNum.second *= tripCount;
+  return true;
+}
+
+bool ScaleHLSEstimator::visitOp(scf::ForOp op, int64_t begin) {
+  auto tripCount = getScfTripCount(op);
+  if (!tripCount)
+    return false;
+  return scheduleSeqLoop(op, {op.getBody()}, tripCount.value(), begin);
+}
+
+bool ScaleHLSEstimator::visitOp(scf::WhileOp op, int64_t begin) {
+  // The trip count of while loops can only be obtained through profiling.
+  auto tripCount = getProfiledTripCount(op);
+  if (!tripCount)
+    return false;
+  return scheduleSeqLoop(op, {op.getBeforeBody(), op.getAfterBody()},
+                         tripCount.value(), begin);
+}
+
+/// Parallel loops are only unrolled by the emitter if required or their trip
+/// counts are small, otherwise they are executed as sequential loops.
+bool ScaleHLSEstimator::visitOp(AffineParallelOp op, int64_t begin) {
+  auto tripCount = getParallelTripCount(op);
+  if (!tripCount)
+    return false;
+  if (!isUnrolledParallelLoop(op))
+    return scheduleSeqLoop(op, {op.getBody()}, tripCount.value(), begin);
+  return scheduleParallelLoop(op, *op.getBody(), tripCount.value(), begin);
+}
+
+bool ScaleHLSEstimator::visitOp(scf::ParallelOp op, int64_t begin) {
+  auto tripCount = getParallelTripCount(op);
+  if (!tripCount)
+    return false;
+  if (!isUnrolledParallelLoop(op))
+    return scheduleSeqLoop(op, {op.getBody()}, tripCount.value(), begin);
+  return scheduleParallelLoop(op, *op.getBody(), tripCount.value(), begin);
+}
+
 //===----------------------------------------------------------------------===//
 // Other Operation Handlers
 //===----------------------------------------------------------------------===//
 
+/// Return the end level of a branch operation. Both sides of branches in
+/// pipelined regions are always executed, while the latency of a sequential
+/// branch is weighted with its profiled probability if available.
+static int64_t getBranchEnd(Operation *op, int64_t begin, int64_t thenEnd,
+                            int64_t elseEnd) {
+  auto probability = getThenProbability(op);
+  if (!probability || isInPipelinedRegion(op))
+    return max(thenEnd, elseEnd);
+
+  auto p = probability.value();
+  return begin + (int64_t)std::ceil(p * (thenEnd - begin) +
+                                    (1 - p) * (elseEnd - begin));
+}
+
 bool ScaleHLSEstimator::visitOp(AffineIfOp op, int64_t begin) {
-  auto end = begin;
+  auto thenEnd = begin;
+  auto elseEnd = begin;
   auto thenBlock = op.getThenBlock();
 
   // Estimate then block.
   if (auto timing = estimateBlock(*thenBlock, begin))
-    end = max(end, timing.getEnd());
+    thenEnd = max(thenEnd, timing.getEnd());
   else
     return false;
 
@@ -529,10 +1545,11 @@ bool ScaleHLSEstimator::visitOp(AffineIfOp op, int64_t begin) {
     auto elseBlock = op.getElseBlock();
 
     if (auto timing = estimateBlock(*elseBlock, begin))
-      end = max(end, timing.getEnd());
+      elseEnd = max(elseEnd, timing.getEnd());
     else
       return false;
   }
+  auto end = getBranchEnd(op, begin, thenEnd, elseEnd);
 
   // In our assumption, AffineIfOp is completely transparent. Therefore, we
   // set a dummy schedule begin here.
@@ -541,22 +1558,24 @@ bool ScaleHLSEstimator::visitOp(AffineIfOp op, int64_t begin) {
 }
 
 bool ScaleHLSEstimator::visitOp(scf::IfOp op, int64_t begin) {
-  auto end = begin;
+  auto thenEnd = begin;
+  auto elseEnd = begin;
   auto thenBlock = op.thenBlock();
 
   // Estimate then block.
   if (auto timing = estimateBlock(*thenBlock, begin))
-    end = max(end, timing.getEnd());
+    thenEnd = max(thenEnd, timing.getEnd());
   else
     return false;
 
   // Handle else block if required.
   if (auto elseBlock = op.elseBlock()) {
     if (auto timing = estimateBlock(*elseBlock, begin))
-      end = max(end, timing.getEnd());
+      elseEnd = max(elseEnd, timing.getEnd());
     else
       return false;
   }
+  auto end = getBranchEnd(op, begin, thenEnd, elseEnd);
 
   // In our assumption, scf::IfOp is completely transparent. Therefore, we
   // set a dummy schedule begin here.
@@ -569,23 +1588,235 @@ bool ScaleHLSEstimator::visitOp(func::CallOp op, int64_t begin) {
   auto subFunc = dyn_cast<func::FuncOp>(callee);
   assert(subFunc && "callable is not a function operation");
 
-  ScaleHLSEstimator estimator(latencyMap, dspUsageMap, depAnalysis);
-  estimator.estimateFunc(subFunc);
+  // Each subfunction is only checked once in an estimation no matter how many
+  // times it is called, and is only estimated if it has been changed since
+  // the last estimation.
+  auto &cache = *calleeResults;
+  auto entryAndInserted = cache.entries.try_emplace(subFunc.getName());
+  auto &entry = entryAndInserted.first->second;
+  if (entryAndInserted.second || entry.epoch != cache.epoch) {
+    entry.epoch = cache.epoch;
+    ++cache.numQueries;
+
+    SmallVector<int64_t, 256> key;
+    SmallVector<Operation *, 64> keyOps;
+    SmallPtrSet<Operation *, 4> callees;
+    callees.insert(subFunc);
+    auto hasKey = getStructureKey(subFunc, key, keyOps, &callees);
+
+    if (hasKey && entry.timing && ArrayRef<int64_t>(entry.key).equals(key)) {
+      ++cache.numHits;
+    } else {
+      auto estimator = clone();
+      estimator.calleeResults = calleeResults;
+      estimator.scheduleFunc(subFunc);
+
+      SmallVector<Operation *, 64> ops;
+      subFunc->walk<WalkOrder::PreOrder>(
+          [&](Operation *nestedOp) { ops.push_back(nestedOp); });
+      entry.results.clear();
+      entry.bottleneckOps.clear();
+      estimator.recordResults(entry, ops, /*begin=*/0);
+
+      entry.key.assign(hasKey ? key.begin() : key.end(), key.end());
+      entry.timing = estimator.getTiming(subFunc);
+      entry.resource = estimator.getResource(subFunc);
+    }
+  }
+
+  // Keep the results of the subfunction such that they can be materialized
+  // together with the current function.
+  replayCalleeResults(subFunc);
 
   // We assume enter and leave the subfunction require extra 2 clock cycles.
-  if (auto timing = getTiming(subFunc)) {
+  if (auto timing = entry.timing) {
     auto latency = timing.getLatency();
     setTiming(op, begin, begin + latency, latency, timing.getInterval());
-    setResource(op, getResource(subFunc));
+    setResource(op, entry.resource);
     return true;
   } else
     return false;
 }
 
+/// Replay the recorded results of the subfunction and all functions called by
+/// it onto the current estimator.
+void ScaleHLSEstimator::replayCalleeResults(func::FuncOp callee) {
+  auto it = calleeResults->entries.find(callee.getName());
+  if (results.count(callee) || it == calleeResults->entries.end())
+    return;
+
+  SmallVector<Operation *, 64> ops;
+  callee->walk<WalkOrder::PreOrder>(
+      [&](Operation *op) { ops.push_back(op); });
+  replayResults(it->second, ops, /*begin=*/0);
+
+  callee.walk([&](func::CallOp call) {
+    if (auto subFunc = SymbolTable::lookupNearestSymbolFrom<func::FuncOp>(
+            call, call.getCalleeAttr()))
+      replayCalleeResults(subFunc);
+  });
+}
+
+/// Get the number of tokens written into a stream channel by a dataflow node,
+/// which is the number of write operations multiplied by the trip counts of
+/// their surrounding loops in the node.
+static int64_t getNumStreamTokens(Value channel) {
+  int64_t numTokens = 0;
+  for (auto user : channel.getUsers()) {
+    if (!isa<StreamWriteOp>(user))
+      continue;
+    int64_t num = 1;
+    for (auto op = user->getParentOp(); !isa<NodeOp>(op);
+         op = op->getParentOp())
+      if (auto loop = dyn_cast<AffineForOp>(op))
+        num *= getAverageTripCount(loop).value_or(1);
+    numTokens += num;
+  }
+  return max(numTokens, (int64_t)1);
+}
+
+namespace {
+/// A buffer or stream channel between a producer and a consumer node.
+struct DataflowChannel {
+  unsigned producer;
+  unsigned consumer;
+  bool isStream;
+  int64_t depth;
+  int64_t numTokens;
+};
+} // namespace
+
+bool ScaleHLSEstimator::visitOp(ScheduleOp op, int64_t begin) {
+  // Nodes are executed concurrently and don't share any resource with each
+  // other, thus each node is estimated separately like a subfunction.
+  SmallVector<NodeOp, 8> nodes(op.getOps<NodeOp>());
+  SmallVector<int64_t, 8> latencies;
+  DenseMap<Value, unsigned> producers;
+  for (auto node : nodes) {
+    auto estimator = clone();
+    estimator.calleeResults = calleeResults;
+    estimator.scheduleNode(node);
+    for (auto &opAndResults : estimator.results)
+      results[opAndResults.first] = opAndResults.second;
+
+    auto timing = getTiming(node);
+    if (!timing)
+      return false;
+    latencies.push_back(timing.getLatency());
+
+    for (auto output : node.getOutputs())
+      producers[output] = latencies.size() - 1;
+  }
+
+  // Collect all buffer and stream channels between nodes. The number of tokens
+  // is counted in the output argument of the producer.
+  SmallVector<DataflowChannel, 16> channels;
+  for (auto nodeAndIdx : llvm::enumerate(nodes)) {
+    auto node = nodeAndIdx.value();
+    for (auto input : node.getInputs()) {
+      auto it = producers.find(input);
+      if (it == producers.end() || it->second == nodeAndIdx.index())
+        continue;
+
+      auto producer = nodes[it->second];
+      auto outputIdx = llvm::find(producer.getOutputs(), input) -
+                       producer.getOutputs().begin();
+      auto outputArg = producer.getBody().getArgument(
+          producer.getNumInputs() + outputIdx);
+
+      DataflowChannel channel;
+      channel.producer = it->second;
+      channel.consumer = nodeAndIdx.index();
+      channel.isStream = input.getType().isa<StreamType>();
+      channel.depth = getBufferDepth(input);
+      channel.numTokens =
+          channel.isStream ? getNumStreamTokens(outputArg) : (int64_t)1;
+      channels.push_back(channel);
+    }
+  }
+
+  // Calculate the begin and end level of each node relative to the schedule.
+  // A consumer of a buffer is started after the producer is finished, while a
+  // consumer of a stream is started once the first token is available and is
+  // stalled until the last token is produced. Meanwhile, the producer is
+  // stalled when the stream is full and only drained by the consumer. As
+  // stalls can propagate backward, iterate until the levels are converged.
+  auto numNodes = nodes.size();
+  auto ceilDiv = [](int64_t a, int64_t b) { return (a + b - 1) / b; };
+  SmallVector<int64_t, 8> begins(numNodes, 0);
+  SmallVector<int64_t, 8> ends(latencies.begin(), latencies.end());
+  for (unsigned iter = 0; iter <= numNodes; ++iter) {
+    bool changed = false;
+    auto update = [&](int64_t &level, int64_t newLevel) {
+      if (newLevel > level)
+        level = newLevel, changed = true;
+    };
+
+    for (unsigned i = 0; i < numNodes; ++i) {
+      for (auto &channel : channels) {
+        if (channel.consumer != i)
+          continue;
+        auto p = channel.producer;
+        if (channel.isStream)
+          update(begins[i],
+                 begins[p] + ceilDiv(latencies[p], channel.numTokens));
+        else
+          update(begins[i], ends[p]);
+      }
+      update(ends[i], begins[i] + latencies[i]);
+
+      for (auto &channel : channels) {
+        if (!channel.isStream)
+          continue;
+        auto p = channel.producer;
+        auto c = channel.consumer;
+        if (c == i)
+          update(ends[i], ends[p] + ceilDiv(latencies[i], channel.numTokens));
+        else if (p == i && channel.numTokens > channel.depth)
+          update(ends[i], begins[c] + (channel.numTokens - channel.depth) *
+                                          latencies[c] / channel.numTokens);
+      }
+    }
+    if (!changed)
+      break;
+  }
+
+  // The steady-state interval is bounded by the busiest node. Buffers with a
+  // depth of N (e.g., ping-pong buffers with a depth of 2) allow the producer
+  // to run up to N - 1 iterations ahead of the consumer.
+  int64_t latency = 0;
+  int64_t interval = 1;
+  for (unsigned i = 0; i < numNodes; ++i) {
+    latency = max(latency, ends[i]);
+    interval = max(interval, ends[i] - begins[i]);
+  }
+  for (auto &channel : channels)
+    if (!channel.isStream)
+      interval = max(interval, ceilDiv(ends[channel.consumer] -
+                                           begins[channel.producer],
+                                       max(channel.depth, (int64_t)1)));
+
+  // Like other operations, nodes are placed at the reversed levels, which will
+  // be reversed back to absolute levels together with the schedule.
+  for (unsigned i = 0; i < numNodes; ++i) {
+    auto nodeLatency = ends[i] - begins[i];
+    setTiming(nodes[i], begin + latency - ends[i], begin + latency - begins[i],
+              nodeLatency, nodeLatency);
+  }
+  setTiming(op, begin, begin + latency, latency, interval);
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 // Block Scheduler and Estimator
 //===----------------------------------------------------------------------===//
 
+/// Return true if the operation is a loop handled by the estimator.
+static bool isEstimatedLoop(Operation *op) {
+  return isa<AffineForOp, AffineParallelOp, scf::ForOp, scf::WhileOp,
+             scf::ParallelOp>(op);
+}
+
 // Get the pointer of the scrOp's parent loop, which should locate at the same
 // level with dstOp's any parent loop.
 static Operation *getSameLevelDstOp(Operation *srcOp, Operation *dstOp) {
@@ -593,14 +1824,14 @@ static Operation *getSameLevelDstOp(Operation *srcOp, Operation *dstOp) {
   if (checkSameLevel(srcOp, dstOp))
     return dstOp;
 
-  // Helper to get all surrouding AffineForOps. AffineIfOps are skipped.
+  // Helper to get all surrouding loops. AffineIfOps are skipped.
   auto getSurroundFors =
       ([&](Operation *op, SmallVector<Operation *, 4> &nests) {
         nests.push_back(op);
         auto currentOp = op;
         while (true) {
           auto parentOp = currentOp->getParentOp();
-          if (isa<AffineForOp>(parentOp)) {
+          if (isEstimatedLoop(parentOp)) {
             nests.push_back(parentOp);
             currentOp = parentOp;
           } else if (isa<AffineIfOp, scf::IfOp>(parentOp))
@@ -626,12 +1857,56 @@ static Operation *getSameLevelDstOp(Operation *srcOp, Operation *dstOp) {
   return nullptr;
 }
 
+/// Get the maximum accumulated delay of the successors of the operation that
+/// are scheduled at the given level, which can be chained with the operation.
+double ScaleHLSEstimator::getSuccChainDelay(Operation *op,
+                                            int64_t level) const {
+  double delay = 0;
+  for (auto user : op->getUsers()) {
+    auto it = results.find(getSameLevelDstOp(op, user));
+    if (it != results.end() && it->second.timing &&
+        it->second.timing.getEnd() == level)
+      delay = max(delay, it->second.chainDelay);
+  }
+  return delay;
+}
+
+namespace {
+/// A memory access nested in (or being) the "ancestor" operation, which is
+/// located in the indexed block. "sameLevelOp" holds the operation whose
+/// timing the access is scheduled with when seen from the indexed block.
+struct BlockAccess {
+  Operation *ancestor;
+  Operation *op;
+  Operation *sameLevelOp;
+};
+
+/// Accesses of each memref grouped in the order of their ancestors.
+using BlockAccessIndex = DenseMap<Value, SmallVector<BlockAccess, 8>>;
+} // namespace
+
+/// Index all memory accesses located in the block. As all operations in the
+/// same block share the same surrounding loops, the same-level operation of
+/// an access only depends on its ancestor and can be computed once.
+static void getBlockAccessIndex(Block &block, BlockAccessIndex &index) {
+  for (auto &ancestor : block)
+    ancestor.walk([&](Operation *op) {
+      for (auto operand : op->getOperands())
+        if (operand.getType().isa<MemRefType>())
+          index[operand].push_back(
+              {&ancestor, op, getSameLevelDstOp(&ancestor, op)});
+    });
+}
+
 /// Estimate the latency of a block with ALAP scheduling strategy, return the
-/// estimated timing attribute.
-TimingAttr ScaleHLSEstimator::estimateBlock(Block &block, int64_t begin) {
+/// estimated timing.
+EstimatedTiming ScaleHLSEstimator::estimateBlock(Block &block, int64_t begin) {
   if (!isa<AffineIfOp, scf::IfOp>(block.getParentOp()))
     totalNumOperatorMap.clear();
 
+  BlockAccessIndex accessIndex;
+  getBlockAccessIndex(block, accessIndex);
+
   auto blockBegin = begin;
   auto blockEnd = begin;
 
@@ -654,30 +1929,34 @@ TimingAttr ScaleHLSEstimator::estimateBlock(Block &block, int64_t begin) {
     // Loop shouldn't overlap with any other scheduled operations. The rationale
     // here is in Vivado HLS, a loop will always be blocked by other operations
     // before it, even if no actual dependency exists between them.
-    if (isa<mlir::AffineForOp>(op))
+    if (isEstimatedLoop(op))
       opBegin = max(opBegin, blockEnd);
 
     // Check memory dependencies of the operation and update schedule level.
     for (auto operand : op->getOperands()) {
       if (operand.getType().isa<MemRefType>())
-        // All users of the same memref value has the possibility to share
-        // dependency with the current operation.
-        for (auto depOp : operand.getUsers()) {
+        // Only accesses located after the current operation are dominated by
+        // it and have been scheduled, all of which have the possibility to
+        // share dependency with the current operation.
+        for (auto &access : llvm::reverse(accessIndex[operand])) {
+          if (!op->isBeforeInBlock(access.ancestor))
+            break;
+
           // If the depOp has not been scheduled or its schedule level will not
           // impact the current operation's scheduling, stop and continue.
-          auto sameLevelDstOp = getSameLevelDstOp(op, depOp);
-          auto depOpTiming = getTiming(sameLevelDstOp);
+          auto depOp = access.op;
+          auto depOpTiming = getTiming(access.sameLevelOp);
           if (!depOpTiming)
             continue;
 
           auto depOpEnd = depOpTiming.getEnd();
-          if (depOpEnd <= opBegin || !DT.properlyDominates(op, depOp))
+          if (depOpEnd <= opBegin)
             continue;
 
           // If either the depOp or the current operation is a function call,
           // dependency exists and the schedule level should be updated.
-          if (isa<func::CallOp, memref::CopyOp>(op) ||
-              isa<func::CallOp, memref::CopyOp>(depOp)) {
+          if (isa<func::CallOp, memref::CopyOp, ScheduleOp>(op) ||
+              isa<func::CallOp, memref::CopyOp, ScheduleOp>(depOp)) {
             opBegin = max(opBegin, depOpEnd);
             continue;
           }
@@ -695,6 +1974,19 @@ TimingAttr ScaleHLSEstimator::estimateBlock(Block &block, int64_t begin) {
               isa<AffineReadOpInterface>(depOp) && depOpMuxSize <= 3)
             continue;
 
+          // Dependencies of non-affine memory accesses, e.g., those in SCF
+          // loops, cannot be analyzed, thus are conservatively assumed to
+          // exist except RAR.
+          auto isAffineAccess = [](Operation *accessOp) {
+            return isa<AffineReadOpInterface, AffineWriteOpInterface>(accessOp);
+          };
+          if (!isAffineAccess(op) || !isAffineAccess(depOp)) {
+            if (!isa<AffineReadOpInterface, memref::LoadOp>(op) ||
+                !isa<AffineReadOpInterface, memref::LoadOp>(depOp))
+              opBegin = max(opBegin, depOpEnd);
+            continue;
+          }
+
           // Now we must check whether any dependency exists between the two
           // operations. If so, update the scheduling level.
           auto opAccess = MemRefAccess(op);
@@ -714,10 +2006,8 @@ TimingAttr ScaleHLSEstimator::estimateBlock(Block &block, int64_t begin) {
                 hasParallelAttr(commonLoops[depth - 1]))
               continue;
 
-            FlatAffineValueConstraints dependConstrs;
-            DependenceResult result = checkMemrefAccessDependence(
-                opAccess, depOpAccess, depth, &dependConstrs,
-                /*dependenceComponents=*/nullptr, /*allowRAR=*/true);
+            DependenceResult result =
+                depCache->checkDependence(opAccess, depOpAccess, depth);
 
             if (hasDependence(result)) {
               opBegin = max(opBegin, depOpEnd);
@@ -732,7 +2022,7 @@ TimingAttr ScaleHLSEstimator::estimateBlock(Block &block, int64_t begin) {
       opEnd = max(opEnd, getTiming(op).getEnd());
     else {
       op->emitError("Failed to estimate op");
-      return TimingAttr();
+      return EstimatedTiming();
     }
 
     // Update the block schedule end and begin.
@@ -744,20 +2034,19 @@ TimingAttr ScaleHLSEstimator::estimateBlock(Block &block, int64_t begin) {
     blockEnd = max(blockEnd, opEnd);
   }
 
-  return TimingAttr::get(block.getParentOp()->getContext(), blockBegin,
-                         blockEnd, blockEnd - blockBegin,
+  return EstimatedTiming(blockBegin, blockEnd, blockEnd - blockBegin,
                          blockEnd - blockBegin);
 }
 
-/// Get the innermost surrounding operation, either an AffineForOp or a
-/// func::FuncOp. In this method, AffineIfOp is transparent as well.
+/// Get the innermost surrounding operation, either a loop, a func::FuncOp, or a
+/// NodeOp. In this method, AffineIfOp is transparent as well.
 static Operation *getSurroundingOp(Operation *op) {
   auto currentOp = op;
   while (true) {
     auto parentOp = currentOp->getParentOp();
-    if (isa<AffineIfOp, scf::IfOp>(parentOp))
+    if (isa<AffineIfOp, scf::IfOp, ScheduleOp>(parentOp))
       currentOp = parentOp;
-    else if (isa<AffineForOp, func::FuncOp>(parentOp))
+    else if (isEstimatedLoop(parentOp) || isa<func::FuncOp, NodeOp>(parentOp))
       return parentOp;
     else
       return nullptr;
@@ -765,7 +2054,13 @@ static Operation *getSurroundingOp(Operation *op) {
 }
 
 void ScaleHLSEstimator::reverseTiming(Block &block) {
+  // Operations in nested dataflow nodes have been reversed when the nodes are
+  // scheduled, thus are skipped here.
+  auto node = dyn_cast<NodeOp>(block.getParentOp());
   block.walk([&](Operation *op) {
+    if (op->getParentOfType<NodeOp>() != node)
+      return;
+
     // Get schedule level.
     if (auto timing = getTiming(op)) {
       auto begin = timing.getBegin();
@@ -775,7 +2070,7 @@ void ScaleHLSEstimator::reverseTiming(Block &block) {
 
       // Reverse schedule level.
       if (auto srd = getSurroundingOp(op)) {
-        if (isa<AffineForOp, scf::ForOp>(srd)) {
+        if (isEstimatedLoop(srd)) {
           auto srdBegin = getTiming(srd).getBegin();
 
           // Handle normal cases.
@@ -788,7 +2083,7 @@ void ScaleHLSEstimator::reverseTiming(Block &block) {
             if (srdDirect.getFlatten())
               setTiming(op, srdBegin, srdBegin + latency, latency, interval);
           }
-        } else if (isa<func::FuncOp>(srd)) {
+        } else if (isa<func::FuncOp, NodeOp>(srd)) {
           auto srdLatency = getTiming(srd).getLatency() - 2;
           setTiming(op, srdLatency - end, srdLatency - begin, latency,
                     interval);
@@ -799,32 +2094,123 @@ void ScaleHLSEstimator::reverseTiming(Block &block) {
   });
 }
 
-void ScaleHLSEstimator::initEstimator(Block &block) {
-  // Clear global maps and scheduling information.
-  memPortInfosMap.clear();
+void ScaleHLSEstimator::initEstimator() {
+  // Clear global maps and scheduling information. The results of the previous
+  // estimation are discarded without walking the IR, as the operations they
+  // are associated with may have been erased.
+  results.clear();
+  memPortTables.clear();
+  reservationLog.clear();
   numOperatorMap.clear();
+  numOperationMap.clear();
+}
 
-  block.walk([&](Operation *op) {
-    if (!isNoTouch(op)) {
-      op->removeAttr("resource");
-      op->removeAttr("timing");
-      op->removeAttr("loop_info");
-    }
-  });
+/// Get the number of LUTs of the multiplexers required by binding a number of
+/// operations to a smaller number of shared instances, where each instance has
+/// inputs of the given bit width. Operations are evenly bound to instances,
+/// and each input is multiplexed with one LUT6 for every three additional
+/// operations bound to the instance.
+static int64_t getSharingMuxLut(int64_t inputBitWidth, int64_t numOperations,
+                                int64_t numInstances) {
+  if (numInstances <= 0 || numOperations <= numInstances)
+    return 0;
+  auto opsPerInstance = numOperations / numInstances;
+  auto numLargerInstances = numOperations % numInstances;
+  auto numMuxes =
+      numLargerInstances * llvm::divideCeil(opsPerInstance, 3) +
+      (numInstances - numLargerInstances) *
+          llvm::divideCeil(opsPerInstance - 1, 3);
+  return inputBitWidth * numMuxes;
+}
+
+/// Get the bit width of an operator, where integer operators are suffixed with
+/// their bit widths and the others are assumed to be 32-bits.
+static int64_t getOperatorBitWidth(StringRef name) {
+  int64_t bitWidth;
+  if (name.rsplit('_').second.getAsInteger(10, bitWidth))
+    return 32;
+  return bitWidth;
+}
+
+/// Get the maximum number of overlapped ranges, each of which is [begin, end).
+static int64_t
+getMaxNumOverlaps(SmallVectorImpl<std::pair<int64_t, int64_t>> &ranges) {
+  SmallVector<std::pair<int64_t, int64_t>, 16> events;
+  for (auto range : ranges) {
+    events.push_back({range.first, 1});
+    events.push_back({max(range.second, range.first + 1), -1});
+  }
+  // Ends are sorted before begins at the same level.
+  llvm::sort(events);
+
+  int64_t numOverlaps = 0;
+  int64_t maxNumOverlaps = 0;
+  for (auto event : events) {
+    numOverlaps += event.second;
+    maxNumOverlaps = max(maxNumOverlaps, numOverlaps);
+  }
+  return maxNumOverlaps;
 }
 
-ResourceAttr ScaleHLSEstimator::calculateResource(Operation *funcOrLoop) {
-  // Calculate the static DSP and BRAM utilization.
+EstimatedResource ScaleHLSEstimator::calculateResource(Operation *funcOrLoop) {
+  // Calculate the static LUT, DSP, BRAM, and FF utilization.
+  int64_t lutNum = 0;
   int64_t dspNum = 0;
   int64_t bramNum = 0;
-  funcOrLoop->walk([&](Operation *op) {
-    if (isa<func::CallOp>(op) || isNoTouch(op)) {
-      // TODO: For now, we consider the resource utilization of sub-fuctions are
-      // static and not shareable. But actually this is not the truth. The
-      // resource can be shared between different sub-functions to some extent,
-      // whose shareing scheme has not been characterized by the estimator.
+  int64_t ffNum = 0;
+
+  // Resources that are not estimated are annotated with negative numbers,
+  // which are ignored here.
+  auto addResource = [&](auto resource) {
+    lutNum += max(resource.getLut(), (int64_t)0);
+    dspNum += max(resource.getDsp(), (int64_t)0);
+    ffNum += max(resource.getFf(), (int64_t)0);
+  };
+
+  // Calls to the same sub-function share one instance of the sub-function if
+  // they are not overlapped. Calls in pipelined regions are never shared.
+  struct CallGroup {
+    EstimatedResource resource;
+    SmallVector<std::pair<int64_t, int64_t>, 8> ranges;
+    int64_t numUnshared = 0;
+    int64_t inputBitWidth = 0;
+  };
+  llvm::MapVector<Operation *, CallGroup> callGroups;
+
+  funcOrLoop->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    if (auto call = dyn_cast<func::CallOp>(op)) {
+      auto resource = getResource(op);
+      if (!resource)
+        return WalkResult::advance();
+
+      auto callee =
+          SymbolTable::lookupNearestSymbolFrom(op, call.getCalleeAttr());
+      auto &group = callGroups[callee];
+      group.resource = resource;
+
+      // Memrefs are accessed through their address ports.
+      group.inputBitWidth = 0;
+      for (auto type : call.getOperandTypes())
+        group.inputBitWidth += type.isa<MemRefType>() ? 32 : getBitWidth(type);
+
+      auto timing = getTiming(op);
+      if (!timing || isInPipelinedRegion(op))
+        ++group.numUnshared;
+      else
+        group.ranges.push_back({timing.getBegin(), timing.getEnd()});
+
+    } else if (isa<NodeOp>(op) && op != funcOrLoop) {
+      // Dataflow nodes are estimated separately and don't share any resource
+      // with other nodes.
       if (auto resource = getResource(op))
-        dspNum += resource.getDsp();
+        addResource(resource);
+      return WalkResult::skip();
+
+    } else if (isNoTouch(op) && op != funcOrLoop) {
+      if (auto resource = hls::getResource(op)) {
+        addResource(resource);
+        return WalkResult::skip();
+      }
 
     } else if (isa<BufferOp>(op)) {
       auto memrefType = op->getResult(0).getType().cast<MemRefType>();
@@ -836,18 +2222,86 @@ ResourceAttr ScaleHLSEstimator::calculateResource(Operation *funcOrLoop) {
         if (!isDram(storageType)) {
           // Multiply bit width of type.
           // TODO: handle index types.
+          // Each buffer is duplicated by its depth, e.g., ping-pong buffers
+          // with a depth of 2.
           int64_t memrefSize = memrefType.getElementTypeBitWidth() *
                                memrefType.getNumElements() / partitionNum;
-          bramNum += ((memrefSize + 18000 - 1) / 18000) * partitionNum;
+          bramNum += ((memrefSize + 18000 - 1) / 18000) * partitionNum *
+                     cast<BufferOp>(op).getDepth();
         }
       }
+
+    } else if (auto streamOp = dyn_cast<StreamOp>(op)) {
+      // Shallow FIFOs are implemented with shift register LUTs, each of which
+      // holds 32 entries of one bit. Deep FIFOs are implemented with BRAMs.
+      // Both of them require a small amount of control logic.
+      auto type = streamOp.getChannel().getType().cast<StreamType>();
+      int64_t bitWidth = getBitWidth(type.getElementType());
+      int64_t depth = type.getDepth();
+      if (depth <= 512) {
+        lutNum += bitWidth * llvm::divideCeil(depth, 32) + 8;
+        ffNum += bitWidth + 8;
+      } else {
+        bramNum += llvm::divideCeil(bitWidth * depth, 18000);
+        lutNum += 16;
+        ffNum += 16;
+      }
+
+    } else if (auto loop = dyn_cast<AffineForOp>(op)) {
+      // Each loop holds an induction variable register with its incrementer
+      // and exit comparator. Loops that are not flattened into their child
+      // loops also hold a state register for each level (or pipeline stage)
+      // of their iteration.
+      auto loopInfo = getLoopInfo(loop);
+      auto tripCount = getAverageTripCount(loop);
+      if (!loopInfo || !tripCount)
+        return WalkResult::advance();
+
+      int64_t bitWidth = llvm::Log2_64_Ceil(tripCount.value() + 1);
+      lutNum += bitWidth * 2;
+      ffNum += bitWidth;
+
+      auto loopDirect = getLoopDirective(loop);
+      if (!loopDirect || loopDirect.getPipeline() || !loopDirect.getFlatten()) {
+        lutNum += loopInfo.getIterLatency();
+        ffNum += loopInfo.getIterLatency();
+      }
+
+    } else if (isa<AffineLoadOp, AffineStoreOp>(op)) {
+      // Accesses with undetermined partition indices require multiplexers to
+      // select the read data from all partitions, which is implemented with
+      // one LUT6 for every three additional inputs, or decoders to generate
+      // the write enable of each partition.
+      auto muxSize = getMaxMuxSize(op);
+      if (muxSize > 1) {
+        auto memrefType = MemRefAccess(op).memref.getType().cast<MemRefType>();
+        if (isa<AffineReadOpInterface>(op))
+          lutNum += getBitWidth(memrefType.getElementType()) *
+                    llvm::divideCeil(muxSize - 1, 3);
+        else
+          lutNum += muxSize;
+      }
     }
+    return WalkResult::advance();
   });
 
+  for (auto &calleeAndGroup : callGroups) {
+    auto &group = calleeAndGroup.second;
+    auto numCalls = group.numUnshared + (int64_t)group.ranges.size();
+    auto numInstances = group.numUnshared + getMaxNumOverlaps(group.ranges);
+    for (int64_t i = 0; i < numInstances; ++i)
+      addResource(group.resource);
+    lutNum += getSharingMuxLut(group.inputBitWidth, numCalls, numInstances);
+  }
+
   auto timing = getTiming(funcOrLoop);
   assert(timing && "timing has not been estimated");
 
+  // The number of operator instances is the maximum number of operators
+  // occupied at any level, while the operations of the whole schedule are
+  // bound to the instances.
   llvm::StringMap<int64_t> operatorNums;
+  llvm::StringMap<int64_t> operationNums;
   for (auto level : numOperatorMap) {
     if (level.first < timing.getBegin() || level.first >= timing.getEnd())
       continue;
@@ -857,15 +2311,63 @@ ResourceAttr ScaleHLSEstimator::calculateResource(Operation *funcOrLoop) {
       num = max(num, nameAndNum.second);
     }
   }
-  for (auto &nameAndNum : operatorNums)
-    dspNum += dspUsageMap[nameAndNum.first()] * nameAndNum.second;
+  for (auto &level : numOperationMap) {
+    if (level.first < timing.getBegin() || level.first >= timing.getEnd())
+      continue;
+
+    for (auto &nameAndNum : level.second)
+      operationNums[nameAndNum.first()] += nameAndNum.second;
+  }
 
-  return ResourceAttr::get(funcOrLoop->getContext(), 0, dspNum, bramNum);
+  for (auto &nameAndNum : operatorNums) {
+    auto name = nameAndNum.first();
+    auto dsp = dspUsageMap.lookup(name);
+    auto lut = lutUsageMap.lookup(name);
+    auto ff = ffUsageMap.lookup(name);
+
+    // Sharing an operator requires multiplexers at both of its inputs. Thus,
+    // operators are only shared if DSPs are saved or the saved LUTs outweigh
+    // the multiplexers, otherwise each operation is bound to its own instance.
+    auto numInstances = nameAndNum.second;
+    auto numOperations = max(operationNums.lookup(name), numInstances);
+    auto muxLut = getSharingMuxLut(2 * getOperatorBitWidth(name),
+                                   numOperations, numInstances);
+    auto numSaved = numOperations - numInstances;
+    if (dsp * numSaved <= 0 && lut * numSaved <= muxLut) {
+      numInstances = numOperations;
+      muxLut = 0;
+    }
+
+    dspNum += dsp * numInstances;
+    lutNum += lut * numInstances + muxLut;
+    ffNum += ff * numInstances;
+  }
+
+  return EstimatedResource(lutNum, dspNum, bramNum, ffNum);
+}
+
+/// Calculate the resource utilization of each loop directly nested in the
+/// function or node if enabled. This must be called before the scheduling
+/// levels are reversed, as operators are recorded with the original levels.
+void ScaleHLSEstimator::calculateLoopResources(Operation *funcOrNode) {
+  if (!loopResources)
+    return;
+  auto node = dyn_cast<NodeOp>(funcOrNode);
+  funcOrNode->walk([&](AffineForOp loop) {
+    if (loop->getParentOfType<NodeOp>() == node && getTiming(loop))
+      setResource(loop, calculateResource(loop));
+  });
 }
 
 void ScaleHLSEstimator::estimateFunc(func::FuncOp func) {
-  initEstimator(func.front());
-  DT = DominanceInfo(func);
+  lastLoopSchedules = std::move(loopSchedules);
+  loopSchedules.clear();
+  ++calleeResults->epoch;
+  scheduleFunc(func);
+}
+
+void ScaleHLSEstimator::scheduleFunc(func::FuncOp func) {
+  initEstimator();
 
   // Collect all memory access operations for later use.
   MemAccessesMap map;
@@ -890,16 +2392,42 @@ void ScaleHLSEstimator::estimateFunc(func::FuncOp func) {
       }
 
     } else if (funcDirect.getPipeline()) {
-      // TODO: support CallOp inside of the function.
+      // Sub-functions called in the pipelined function are sub-pipelines,
+      // whose intervals constrain the interval of the function.
       auto targetInterval = funcDirect.getTargetInterval();
-      auto resInterval = getResMinII(0, timing.getEnd(), map);
-      auto depInterval =
-          getDepMinII(max(targetInterval, resInterval), func, map);
+      EstimatedIIBottleneck bottleneck;
+      updateBottleneck(&bottleneck, EstimatedIIBottleneck::Kind::Target,
+                       targetInterval, nullptr);
+
+      auto resInterval =
+          max({getResMinII(0, timing.getEnd(), map, &bottleneck),
+               getStreamMinII(func.front(), &bottleneck),
+               getCallMinII(func.front(), &bottleneck)});
+      auto depInterval = getDepMinII(max(targetInterval, resInterval), func,
+                                     map, &bottleneck);
       interval = max({targetInterval, resInterval, depInterval});
-      // TODO: Tune numOperatorMap like visitOp(AffineForOp op);
+      results[func].bottleneck = bottleneck;
+
+      // Same as pipelined loops, all operators are shared inside of the
+      // interval of the pipelined function.
+      for (auto &pair : totalNumOperatorMap)
+        pair.second = (pair.second + interval - 1) / interval;
+
+      for (auto i = (int64_t)0; i < timing.getEnd(); ++i)
+        numOperatorMap.erase(i);
+      numOperatorMap[0] = totalNumOperatorMap;
     }
   }
 
+  // Dataflow schedules in the function can be started again once their
+  // steady-state interval is passed.
+  int64_t dataflowInterval = 0;
+  for (auto schedule : func.getOps<ScheduleOp>())
+    dataflowInterval =
+        max(dataflowInterval, getTiming(schedule).getInterval());
+  if (dataflowInterval)
+    interval = min(interval, dataflowInterval);
+
   // Estimate and set timing and resource attributes.
   setTiming(func, 0, latency, latency, interval);
   setResource(func, calculateResource(func));
@@ -908,20 +2436,135 @@ void ScaleHLSEstimator::estimateFunc(func::FuncOp func) {
   // we have done the ALAP scheduling in a reverse order. Note that after
   // the reverse, the annotated scheduling level of each operation is a
   // relative level of the nearest surrounding AffineForOp or func::FuncOp.
+  calculateLoopResources(func);
   reverseTiming(func.front());
 }
 
+void ScaleHLSEstimator::scheduleNode(NodeOp node) {
+  initEstimator();
+
+  // Dataflow nodes are estimated in the same way as functions.
+  auto &nodeBlock = node.getBody().front();
+  auto timing = estimateBlock(nodeBlock);
+  if (!timing)
+    return;
+
+  auto latency = timing.getEnd() + 2;
+  setTiming(node, 0, latency, latency, latency);
+  setResource(node, calculateResource(node));
+  calculateLoopResources(node);
+  reverseTiming(nodeBlock);
+}
+
 void ScaleHLSEstimator::estimateLoop(AffineForOp loop, func::FuncOp func) {
-  initEstimator(func.getBody().front());
-  DT = DominanceInfo(loop);
+  lastLoopSchedules = std::move(loopSchedules);
+  loopSchedules.clear();
+  ++calleeResults->epoch;
+  initEstimator();
   visitOp(loop, 0);
   setResource(loop, calculateResource(loop));
 }
 
+EstimatedTiming ScaleHLSEstimator::getTiming(Operation *op) const {
+  auto it = results.find(op);
+  return it == results.end() ? EstimatedTiming() : it->second.timing;
+}
+
+EstimatedResource ScaleHLSEstimator::getResource(Operation *op) const {
+  auto it = results.find(op);
+  return it == results.end() ? EstimatedResource() : it->second.resource;
+}
+
+EstimatedLoopInfo ScaleHLSEstimator::getLoopInfo(Operation *op) const {
+  auto it = results.find(op);
+  return it == results.end() ? EstimatedLoopInfo() : it->second.loopInfo;
+}
+
+EstimatedIIBottleneck ScaleHLSEstimator::getIIBottleneck(Operation *op) const {
+  auto it = results.find(op);
+  return it == results.end() ? EstimatedIIBottleneck() : it->second.bottleneck;
+}
+
+void ScaleHLSEstimator::materializeAttributes(Operation *root) {
+  auto materializeFunc = [&](func::FuncOp func) {
+    if (!results.count(func))
+      return;
+
+    auto builder = Builder(func);
+    func.walk([&](Operation *op) {
+      // Stale results of no_touch operations are kept, as they are provided
+      // by the user rather than the estimator.
+      if (!isNoTouch(op)) {
+        op->removeAttr("resource");
+        op->removeAttr("timing");
+        op->removeAttr("loop_info");
+      }
+
+      auto it = results.find(op);
+      if (it == results.end())
+        return;
+      auto &opResults = it->second;
+
+      if (auto timing = opResults.timing)
+        hls::setTiming(op, timing.getBegin(), timing.getEnd(),
+                       timing.getLatency(), timing.getInterval());
+      if (auto resource = opResults.resource)
+        hls::setResource(op, resource.getLut(), resource.getDsp(),
+                         resource.getBram(), resource.getFf());
+      if (auto loopInfo = opResults.loopInfo)
+        hls::setLoopInfo(op, loopInfo.getFlattenTripCount(),
+                         loopInfo.getIterLatency(), loopInfo.getMinII());
+
+      if (!opResults.partitionIndices.empty()) {
+        op->setAttr("partition_indices",
+                    builder.getI64ArrayAttr(opResults.partitionIndices));
+        if (llvm::is_contained(opResults.partitionIndices, -1))
+          op->setAttr("max_mux_size",
+                      builder.getI64IntegerAttr(opResults.maxMuxSize));
+      }
+    });
+  };
+
+  if (auto func = dyn_cast<func::FuncOp>(root))
+    materializeFunc(func);
+  else
+    root->walk(materializeFunc);
+}
+
 //===----------------------------------------------------------------------===//
 // Entry of scalehls-opt
 //===----------------------------------------------------------------------===//
 
+static const unsigned intBitWidths[] = {8, 16, 32, 64};
+
+std::string scalehls::getIntOperatorKey(StringRef name, unsigned bitWidth) {
+  for (auto width : intBitWidths)
+    if (bitWidth <= width || width == intBitWidths[3])
+      return (name + "_" + Twine(width)).str();
+  llvm_unreachable("invalid bit width");
+}
+
+/// Get the costs of an integer operator of each bit width. The costs can be
+/// specified with either a single integer for all bit widths, or an object
+/// mapping each bit width to an integer. Missing bit widths are set to the
+/// default values, which are ordered as 8, 16, 32, and 64 bits.
+static void getIntOperatorMap(llvm::json::Object *costs, StringRef name,
+                              ArrayRef<int64_t> defaults,
+                              llvm::StringMap<int64_t> &map) {
+  auto costValue = costs ? costs->get(name) : nullptr;
+  for (unsigned i = 0; i < 4; ++i) {
+    auto cost = defaults[i];
+    if (costValue) {
+      if (auto costInt = costValue->getAsInteger())
+        cost = costInt.value();
+      else if (auto costObj = costValue->getAsObject())
+        cost = costObj->getInteger(std::to_string(intBitWidths[i]))
+                   .value_or(cost);
+    }
+    map[getIntOperatorKey(name, intBitWidths[i])] = cost;
+  }
+}
+
 void scalehls::getLatencyMap(llvm::json::Object *config,
                              llvm::StringMap<int64_t> &latencyMap) {
   auto frequency =
@@ -932,6 +2575,108 @@ void scalehls::getLatencyMap(llvm::json::Object *config,
   latencyMap["fdiv"] = frequency->getInteger("fdiv").value_or(15);
   latencyMap["fcmp"] = frequency->getInteger("fcmp").value_or(1);
   latencyMap["fexp"] = frequency->getInteger("fexp").value_or(8);
+
+  // Latencies of integer operators, where zero means the operator is
+  // combinational and can be chained with its successors.
+  getIntOperatorMap(frequency, "add", {0, 0, 0, 1}, latencyMap);
+  getIntOperatorMap(frequency, "mul", {1, 1, 2, 5}, latencyMap);
+  getIntOperatorMap(frequency, "div", {12, 20, 36, 68}, latencyMap);
+  getIntOperatorMap(frequency, "rem", {12, 20, 36, 68}, latencyMap);
+  getIntOperatorMap(frequency, "cmp", {0, 0, 0, 0}, latencyMap);
+  getIntOperatorMap(frequency, "shift", {0, 0, 0, 0}, latencyMap);
+  getIntOperatorMap(frequency, "logic", {0, 0, 0, 0}, latencyMap);
+  getIntOperatorMap(frequency, "minmax", {0, 0, 0, 0}, latencyMap);
+  getIntOperatorMap(frequency, "select", {0, 0, 0, 0}, latencyMap);
+  getIntOperatorMap(frequency, "cast", {0, 0, 0, 0}, latencyMap);
+  latencyMap["prim_mul"] = frequency->getInteger("prim_mul").value_or(2);
+
+  // Extra cycles of entering and leaving a pipelined or sequential loop, and
+  // of each iteration of a sequential loop. These can be calibrated against
+  // synthesis reports with the scalehls-calibrate tool.
+  latencyMap["pipeline_overhead"] =
+      frequency->getInteger("pipeline_overhead").value_or(2);
+  latencyMap["loop_overhead"] =
+      frequency->getInteger("loop_overhead").value_or(2);
+  latencyMap["loop_iter_overhead"] =
+      frequency->getInteger("loop_iter_overhead").value_or(0);
+}
+
+/// Get the delays of an integer operator of each bit width, which are specified
+/// in the same way as the other costs but with a "_delay" suffix.
+static void getIntOperatorDelayMap(llvm::json::Object *delays, StringRef name,
+                                   ArrayRef<double> defaults,
+                                   llvm::StringMap<double> &map) {
+  auto delayValue = delays ? delays->get((name + "_delay").str()) : nullptr;
+  for (unsigned i = 0; i < 4; ++i) {
+    auto delay = defaults[i];
+    if (delayValue) {
+      if (auto delayNum = delayValue->getAsNumber())
+        delay = delayNum.value();
+      else if (auto delayObj = delayValue->getAsObject())
+        delay = delayObj->getNumber(std::to_string(intBitWidths[i]))
+                    .value_or(delay);
+    }
+    map[getIntOperatorKey(name, intBitWidths[i])] = delay;
+  }
+}
+
+void scalehls::getDelayMap(llvm::json::Object *config,
+                           llvm::StringMap<double> &delayMap) {
+  auto frequency =
+      config->getObject(config->getString("frequency").value_or("100MHz"));
+
+  delayMap["fadd"] = frequency->getNumber("fadd_delay").value_or(7.25);
+  delayMap["fmul"] = frequency->getNumber("fmul_delay").value_or(5.7);
+  delayMap["fdiv"] = frequency->getNumber("fdiv_delay").value_or(6.07);
+  delayMap["fcmp"] = frequency->getNumber("fcmp_delay").value_or(6.4);
+  delayMap["fexp"] = frequency->getNumber("fexp_delay").value_or(7.68);
+
+  // Delays of integer operators. For multi-cycle operators, this is the delay
+  // of the first stage, which can be chained with their predecessors.
+  getIntOperatorDelayMap(frequency, "add", {1.5, 2.0, 2.6, 3.5}, delayMap);
+  getIntOperatorDelayMap(frequency, "mul", {3.4, 3.4, 3.9, 3.9}, delayMap);
+  getIntOperatorDelayMap(frequency, "div", {1.8, 2.1, 2.6, 3.5}, delayMap);
+  getIntOperatorDelayMap(frequency, "rem", {1.8, 2.1, 2.6, 3.5}, delayMap);
+  getIntOperatorDelayMap(frequency, "cmp", {1.1, 1.5, 2.5, 3.4}, delayMap);
+  getIntOperatorDelayMap(frequency, "shift", {1.2, 1.6, 2.0, 2.4}, delayMap);
+  getIntOperatorDelayMap(frequency, "logic", {0.8, 0.8, 0.8, 0.8}, delayMap);
+  getIntOperatorDelayMap(frequency, "minmax", {1.8, 2.2, 3.2, 4.1}, delayMap);
+  getIntOperatorDelayMap(frequency, "select", {0.7, 0.7, 0.7, 0.7}, delayMap);
+  getIntOperatorDelayMap(frequency, "cast", {0, 0, 0, 0}, delayMap);
+  delayMap["prim_mul"] = frequency->getNumber("prim_mul_delay").value_or(3.4);
+}
+
+void scalehls::getAxiMap(llvm::json::Object *config,
+                         llvm::StringMap<int64_t> &axiMap) {
+  auto axi = config->getObject("axi");
+  auto getConfig = [&](StringRef key, int64_t defaultValue) {
+    return axi ? axi->getInteger(key).value_or(defaultValue) : defaultValue;
+  };
+
+  axiMap["port_width"] = getConfig("port_width", 64);
+  axiMap["max_burst_length"] = getConfig("max_burst_length", 16);
+  axiMap["num_outstanding"] = getConfig("num_outstanding", 16);
+  axiMap["latency"] = getConfig("latency", 64);
+}
+
+double scalehls::getClockPeriod(llvm::json::Object *config) {
+  // The clock period is either explicitly specified or derived from the
+  // frequency, such as 10ns for "100MHz".
+  double period = 10;
+  if (auto clockPeriod = config->getNumber("clock_period"))
+    period = clockPeriod.value();
+  else {
+    auto frequency = config->getString("frequency").value_or("100MHz");
+    double megaHertz;
+    if (frequency.consume_back("MHz") && !frequency.getAsDouble(megaHertz) &&
+        megaHertz > 0)
+      period = 1000 / megaHertz;
+  }
+
+  // The default clock uncertainty is 27% of the clock period as in Vitis HLS.
+  auto uncertainty =
+      config->getNumber("clock_uncertainty").value_or(period * 0.27);
+  return period - uncertainty;
 }
 
 void scalehls::getDspUsageMap(llvm::json::Object *config,
@@ -943,6 +2688,413 @@ void scalehls::getDspUsageMap(llvm::json::Object *config,
   dspUsageMap["fdiv"] = dspUsage->getInteger("fdiv").value_or(0);
   dspUsageMap["fcmp"] = dspUsage->getInteger("fcmp").value_or(0);
   dspUsageMap["fexp"] = dspUsage->getInteger("fexp").value_or(7);
+
+  // DSP usages of integer operators. Only multipliers are mapped to DSPs by
+  // default.
+  getIntOperatorMap(dspUsage, "add", {0, 0, 0, 0}, dspUsageMap);
+  getIntOperatorMap(dspUsage, "mul", {1, 1, 3, 10}, dspUsageMap);
+  getIntOperatorMap(dspUsage, "div", {0, 0, 0, 0}, dspUsageMap);
+  getIntOperatorMap(dspUsage, "rem", {0, 0, 0, 0}, dspUsageMap);
+  getIntOperatorMap(dspUsage, "cmp", {0, 0, 0, 0}, dspUsageMap);
+  getIntOperatorMap(dspUsage, "shift", {0, 0, 0, 0}, dspUsageMap);
+  getIntOperatorMap(dspUsage, "logic", {0, 0, 0, 0}, dspUsageMap);
+  getIntOperatorMap(dspUsage, "minmax", {0, 0, 0, 0}, dspUsageMap);
+  getIntOperatorMap(dspUsage, "select", {0, 0, 0, 0}, dspUsageMap);
+  getIntOperatorMap(dspUsage, "cast", {0, 0, 0, 0}, dspUsageMap);
+  dspUsageMap["prim_mul"] = dspUsage->getInteger("prim_mul").value_or(1);
+}
+
+void scalehls::getLutUsageMap(llvm::json::Object *config,
+                              llvm::StringMap<int64_t> &lutUsageMap) {
+  auto lutUsage = config->getObject("lut_usage");
+  auto getUsage = [&](StringRef name, int64_t defaultUsage) {
+    return lutUsage ? lutUsage->getInteger(name).value_or(defaultUsage)
+                    : defaultUsage;
+  };
+
+  lutUsageMap["fadd"] = getUsage("fadd", 390);
+  lutUsageMap["fmul"] = getUsage("fmul", 321);
+  lutUsageMap["fdiv"] = getUsage("fdiv", 994);
+  lutUsageMap["fcmp"] = getUsage("fcmp", 239);
+  lutUsageMap["fexp"] = getUsage("fexp", 924);
+
+  getIntOperatorMap(lutUsage, "add", {8, 16, 32, 64}, lutUsageMap);
+  getIntOperatorMap(lutUsage, "mul", {0, 0, 20, 88}, lutUsageMap);
+  getIntOperatorMap(lutUsage, "div", {91, 282, 1062, 4000}, lutUsageMap);
+  getIntOperatorMap(lutUsage, "rem", {91, 282, 1062, 4000}, lutUsageMap);
+  getIntOperatorMap(lutUsage, "cmp", {3, 6, 11, 22}, lutUsageMap);
+  getIntOperatorMap(lutUsage, "shift", {24, 64, 160, 384}, lutUsageMap);
+  getIntOperatorMap(lutUsage, "logic", {8, 16, 32, 64}, lutUsageMap);
+  getIntOperatorMap(lutUsage, "minmax", {11, 22, 43, 86}, lutUsageMap);
+  getIntOperatorMap(lutUsage, "select", {8, 16, 32, 64}, lutUsageMap);
+  getIntOperatorMap(lutUsage, "cast", {0, 0, 0, 0}, lutUsageMap);
+  lutUsageMap["prim_mul"] = getUsage("prim_mul", 0);
+}
+
+void scalehls::getFfUsageMap(llvm::json::Object *config,
+                             llvm::StringMap<int64_t> &ffUsageMap) {
+  auto ffUsage = config->getObject("ff_usage");
+  auto getUsage = [&](StringRef name, int64_t defaultUsage) {
+    return ffUsage ? ffUsage->getInteger(name).value_or(defaultUsage)
+                   : defaultUsage;
+  };
+
+  ffUsageMap["fadd"] = getUsage("fadd", 205);
+  ffUsageMap["fmul"] = getUsage("fmul", 143);
+  ffUsageMap["fdiv"] = getUsage("fdiv", 761);
+  ffUsageMap["fcmp"] = getUsage("fcmp", 66);
+  ffUsageMap["fexp"] = getUsage("fexp", 277);
+
+  // Only multi-cycle integer operators require pipeline registers by default.
+  getIntOperatorMap(ffUsage, "add", {0, 0, 0, 64}, ffUsageMap);
+  getIntOperatorMap(ffUsage, "mul", {16, 32, 165, 340}, ffUsageMap);
+  getIntOperatorMap(ffUsage, "div", {98, 338, 1350, 4900}, ffUsageMap);
+  getIntOperatorMap(ffUsage, "rem", {98, 338, 1350, 4900}, ffUsageMap);
+  getIntOperatorMap(ffUsage, "cmp", {0, 0, 0, 0}, ffUsageMap);
+  getIntOperatorMap(ffUsage, "shift", {0, 0, 0, 0}, ffUsageMap);
+  getIntOperatorMap(ffUsage, "logic", {0, 0, 0, 0}, ffUsageMap);
+  getIntOperatorMap(ffUsage, "minmax", {0, 0, 0, 0}, ffUsageMap);
+  getIntOperatorMap(ffUsage, "select", {0, 0, 0, 0}, ffUsageMap);
+  getIntOperatorMap(ffUsage, "cast", {0, 0, 0, 0}, ffUsageMap);
+  ffUsageMap["prim_mul"] = getUsage("prim_mul", 32);
+}
+
+//===----------------------------------------------------------------------===//
+// QoR Report
+//===----------------------------------------------------------------------===//
+
+using IIBottleneckMap = DenseMap<Operation *, EstimatedIIBottleneck>;
+
+/// Get the memref or stream channel accessed by the operation.
+static Value getAccessedValue(Operation *op) {
+  if (auto read = dyn_cast<AffineReadOpInterface>(op))
+    return read.getMemRef();
+  if (auto write = dyn_cast<AffineWriteOpInterface>(op))
+    return write.getMemRef();
+  if (auto read = dyn_cast<StreamReadOp>(op))
+    return read.getChannel();
+  if (auto write = dyn_cast<StreamWriteOp>(op))
+    return write.getChannel();
+  return nullptr;
+}
+
+/// Describe the limiting cause of the II of a pipelined loop, where the values
+/// are named with the given AsmState.
+static std::string
+getIIBottleneckDescription(const EstimatedIIBottleneck &bottleneck,
+                           AsmState &state) {
+  std::string description;
+  llvm::raw_string_ostream os(description);
+  auto printAccess = [&](Operation *op) {
+    if (auto value = op ? getAccessedValue(op) : Value())
+      value.printAsOperand(os, state);
+    else
+      os << "<unknown>";
+  };
+
+  using Kind = EstimatedIIBottleneck::Kind;
+  switch (bottleneck.kind) {
+  case Kind::None:
+  case Kind::Target:
+    os << "target II";
+    break;
+  case Kind::Resource:
+    os << "ports of partition " << bottleneck.partition << " of ";
+    printAccess(bottleneck.srcOp);
+    break;
+  case Kind::Stream:
+    os << "accesses of stream ";
+    printAccess(bottleneck.srcOp);
+    break;
+  case Kind::Axi:
+    os << "bandwidth of the AXI bundle of ";
+    printAccess(bottleneck.srcOp);
+    break;
+  case Kind::Call:
+    os << "interval of the call to @"
+       << cast<func::CallOp>(bottleneck.srcOp).getCallee();
+    break;
+  case Kind::Dependence:
+    os << "dependence from " << bottleneck.srcOp->getName() << " of ";
+    printAccess(bottleneck.srcOp);
+    os << " to " << bottleneck.dstOp->getName() << " of ";
+    printAccess(bottleneck.dstOp);
+    os << " with distance " << bottleneck.distance;
+    break;
+  }
+  return os.str();
+}
+
+static llvm::json::Value
+getIIBottleneckReport(const EstimatedIIBottleneck &bottleneck,
+                      AsmState &state) {
+  llvm::json::Object report{
+      {"kind", bottleneck.getKindName()},
+      {"ii", bottleneck.II},
+      {"description", getIIBottleneckDescription(bottleneck, state)}};
+  if (bottleneck.kind == EstimatedIIBottleneck::Kind::Resource)
+    report["partition"] = bottleneck.partition;
+  if (bottleneck.kind == EstimatedIIBottleneck::Kind::Dependence)
+    report["distance"] = bottleneck.distance;
+  return report;
+}
+
+static void addResourceToReport(llvm::json::Object &report, Operation *op) {
+  auto resource = hls::getResource(op);
+  auto getValue = [&](int64_t value) -> llvm::json::Value {
+    if (!resource)
+      return nullptr;
+    return value;
+  };
+  report["lut"] = getValue(resource ? resource.getLut() : 0);
+  report["dsp"] = getValue(resource ? resource.getDsp() : 0);
+  report["bram"] = getValue(resource ? resource.getBram() : 0);
+  report["ff"] = getValue(resource ? resource.getFf() : 0);
+}
+
+/// Get the report of the memrefs accessed in the loop, including the partition
+/// factor of each dimension.
+static llvm::json::Array getMemrefReport(AffineForOp loop, AsmState &state) {
+  llvm::SetVector<Value> memrefs;
+  loop.walk([&](Operation *op) {
+    if (auto read = dyn_cast<AffineReadOpInterface>(op))
+      memrefs.insert(read.getMemRef());
+    else if (auto write = dyn_cast<AffineWriteOpInterface>(op))
+      memrefs.insert(write.getMemRef());
+    else if (auto load = dyn_cast<memref::LoadOp>(op))
+      memrefs.insert(load.getMemRef());
+    else if (auto store = dyn_cast<memref::StoreOp>(op))
+      memrefs.insert(store.getMemRef());
+  });
+
+  llvm::json::Array report;
+  for (auto memref : memrefs) {
+    std::string name;
+    llvm::raw_string_ostream nameStream(name);
+    memref.printAsOperand(nameStream, state);
+
+    SmallVector<int64_t, 8> factors;
+    getPartitionFactors(memref.getType().cast<MemRefType>(), &factors);
+    report.push_back(llvm::json::Object{
+        {"name", nameStream.str()},
+        {"partition_factors", llvm::json::Array(factors)}});
+  }
+  return report;
+}
+
+/// Collect the reports of all estimated loops nested in the given operation.
+/// Loops are named hierarchically, e.g., "Loop 1.2" is the second loop nested
+/// in the first loop, following the convention of HLS synthesis reports.
+static void addLoopsToReport(llvm::json::Array &report, Operation *parentOp,
+                             StringRef prefix, AsmState &state,
+                             const IIBottleneckMap &bottlenecks) {
+  unsigned loopIndex = 0;
+  parentOp->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    auto loop = dyn_cast<AffineForOp>(op);
+    auto timing = hls::getTiming(op);
+    if (op == parentOp || !loop || !timing)
+      return WalkResult::advance();
+
+    auto name = (prefix + Twine(++loopIndex)).str();
+    llvm::json::Object loopReport{{"name", name},
+                                  {"latency", timing.getLatency()}};
+
+    if (auto tripCount = getAverageTripCount(loop))
+      loopReport["trip_count"] = (int64_t)tripCount.value();
+    else
+      loopReport["trip_count"] = nullptr;
+
+    loopReport["iter_latency"] = nullptr;
+    loopReport["ii"] = nullptr;
+    if (auto loopInfo = hls::getLoopInfo(op)) {
+      loopReport["iter_latency"] = loopInfo.getIterLatency();
+      loopReport["ii"] = loopInfo.getMinII();
+    }
+
+    loopReport["pipeline"] = false;
+    loopReport["flatten"] = false;
+    loopReport["target_ii"] = nullptr;
+    if (auto directive = hls::getLoopDirective(op)) {
+      loopReport["pipeline"] = directive.getPipeline();
+      loopReport["flatten"] = directive.getFlatten();
+      if (directive.getPipeline())
+        loopReport["target_ii"] = directive.getTargetII();
+    }
+
+    auto it = bottlenecks.find(op);
+    if (it != bottlenecks.end())
+      loopReport["ii_bottleneck"] = getIIBottleneckReport(it->second, state);
+    else
+      loopReport["ii_bottleneck"] = nullptr;
+
+    addResourceToReport(loopReport, op);
+    loopReport["memrefs"] = getMemrefReport(loop, state);
+    report.push_back(std::move(loopReport));
+
+    addLoopsToReport(report, op, name + ".", state, bottlenecks);
+    return WalkResult::skip();
+  });
+}
+
+/// Get the QoR report of all estimated functions in the module.
+static llvm::json::Array getQoRReport(ModuleOp module,
+                                      const IIBottleneckMap &bottlenecks) {
+  llvm::json::Array report;
+  for (auto func : module.getOps<func::FuncOp>()) {
+    auto timing = hls::getTiming(func);
+    if (!timing)
+      continue;
+
+    llvm::json::Object funcReport{{"name", func.getName()},
+                                  {"latency", timing.getLatency()},
+                                  {"interval", timing.getInterval()}};
+    addResourceToReport(funcReport, func);
+
+    AsmState state(func);
+    auto it = bottlenecks.find(func);
+    if (it != bottlenecks.end())
+      funcReport["ii_bottleneck"] = getIIBottleneckReport(it->second, state);
+
+    llvm::json::Array loopsReport;
+    addLoopsToReport(loopsReport, func, "Loop ", state, bottlenecks);
+    funcReport["loops"] = std::move(loopsReport);
+    report.push_back(std::move(funcReport));
+  }
+  return report;
+}
+
+/// Print a table with the given header and rows, where each column is aligned
+/// to its widest cell.
+static void printTable(raw_ostream &os, ArrayRef<StringRef> header,
+                       ArrayRef<SmallVector<std::string, 16>> rows) {
+  SmallVector<size_t, 16> widths;
+  for (auto title : header)
+    widths.push_back(title.size());
+  for (auto &row : rows)
+    for (auto cell : llvm::enumerate(row))
+      widths[cell.index()] = max(widths[cell.index()], cell.value().size());
+
+  auto printSeparator = [&]() {
+    for (auto width : widths)
+      os << "+" << std::string(width + 2, '-');
+    os << "+\n";
+  };
+  auto printRow = [&](auto cells) {
+    for (auto cell : llvm::enumerate(cells))
+      os << "| " << llvm::left_justify(cell.value(), widths[cell.index()])
+         << " ";
+    os << "|\n";
+  };
+
+  printSeparator();
+  printRow(header);
+  printSeparator();
+  for (auto &row : rows)
+    printRow(ArrayRef<std::string>(row));
+  printSeparator();
+}
+
+static std::string getReportCell(const llvm::json::Object &report,
+                                 StringRef key) {
+  if (auto value = report.getInteger(key))
+    return std::to_string(value.value());
+  if (auto value = report.getBoolean(key))
+    return value.value() ? "yes" : "no";
+  if (auto value = report.getString(key))
+    return value.value().str();
+  return "-";
+}
+
+/// Print the QoR report in a text format similar to HLS synthesis reports.
+static void printQoRReport(raw_ostream &os, const llvm::json::Array &report) {
+  for (auto &funcValue : report) {
+    auto &funcReport = *funcValue.getAsObject();
+    os << "================================================================\n";
+    os << "== Function: " << getReportCell(funcReport, "name") << "\n";
+    os << "================================================================\n";
+
+    os << "+ Performance Estimates:\n";
+    printTable(os, {"Latency", "Interval"},
+               {{getReportCell(funcReport, "latency"),
+                 getReportCell(funcReport, "interval")}});
+
+    os << "+ Utilization Estimates:\n";
+    printTable(os, {"DSP", "BRAM_18K", "FF", "LUT"},
+               {{getReportCell(funcReport, "dsp"),
+                 getReportCell(funcReport, "bram"),
+                 getReportCell(funcReport, "ff"),
+                 getReportCell(funcReport, "lut")}});
+
+    auto loopsReport = funcReport.getArray("loops");
+    if (!loopsReport || loopsReport->empty()) {
+      os << "\n";
+      continue;
+    }
+
+    SmallVector<SmallVector<std::string, 16>, 16> rows;
+    for (auto &loopValue : *loopsReport) {
+      auto &loopReport = *loopValue.getAsObject();
+
+      // Indent nested loops with their depth.
+      auto name = getReportCell(loopReport, "name");
+      auto indent = std::string(2 * llvm::count(name, '.'), ' ');
+
+      std::string memrefs;
+      llvm::raw_string_ostream memrefsStream(memrefs);
+      if (auto memrefsReport = loopReport.getArray("memrefs"))
+        llvm::interleaveComma(*memrefsReport, memrefsStream, [&](auto &value) {
+          auto &memrefReport = *value.getAsObject();
+          memrefsStream << getReportCell(memrefReport, "name") << "<";
+          if (auto factors = memrefReport.getArray("partition_factors"))
+            llvm::interleave(
+                *factors, memrefsStream,
+                [&](auto &factor) {
+                  memrefsStream << factor.getAsInteger().value_or(1);
+                },
+                "x");
+          memrefsStream << ">";
+        });
+
+      std::string bottleneck = "-";
+      if (auto bottleneckReport = loopReport.getObject("ii_bottleneck"))
+        bottleneck = getReportCell(*bottleneckReport, "description");
+
+      rows.push_back({indent + "- " + name,
+                      getReportCell(loopReport, "latency"),
+                      getReportCell(loopReport, "iter_latency"),
+                      getReportCell(loopReport, "ii"),
+                      getReportCell(loopReport, "target_ii"), bottleneck,
+                      getReportCell(loopReport, "trip_count"),
+                      getReportCell(loopReport, "pipeline"),
+                      getReportCell(loopReport, "flatten"),
+                      getReportCell(loopReport, "dsp"),
+                      getReportCell(loopReport, "bram"),
+                      memrefsStream.str()});
+    }
+
+    os << "+ Loop:\n";
+    printTable(os,
+               {"Loop Name", "Latency", "Iteration Latency", "Achieved II",
+                "Target II", "II Bottleneck", "Trip Count", "Pipelined",
+                "Flattened", "DSP", "BRAM_18K", "Memrefs<Partition Factors>"},
+               rows);
+    os << "\n";
+  }
+}
+
+/// Write the report to the given file path through the print function.
+static LogicalResult
+writeQoRReport(StringRef filePath,
+               llvm::function_ref<void(raw_ostream &)> printFn) {
+  std::string errorMessage;
+  auto output = mlir::openOutputFile(filePath, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return failure();
+  }
+  printFn(output->os());
+  output->keep();
+  return success();
 }
 
 namespace {
@@ -974,19 +3126,95 @@ struct QoREstimation : public scalehls::QoREstimationBase<QoREstimation> {
       return signalPassFailure();
     }
 
-    // Collect profiling latency and DSP usage data, where default values are
-    // based on Xilinx PYNQ-Z1 board.
+    // Collect profiling latency, DSP, LUT, FF usage, and delay data, where
+    // default values are based on Xilinx PYNQ-Z1 board.
     llvm::StringMap<int64_t> latencyMap;
     getLatencyMap(configObj, latencyMap);
     llvm::StringMap<int64_t> dspUsageMap;
     getDspUsageMap(configObj, dspUsageMap);
+    llvm::StringMap<int64_t> lutUsageMap;
+    getLutUsageMap(configObj, lutUsageMap);
+    llvm::StringMap<int64_t> ffUsageMap;
+    getFfUsageMap(configObj, ffUsageMap);
+    llvm::StringMap<int64_t> axiMap;
+    getAxiMap(configObj, axiMap);
+    llvm::StringMap<double> delayMap;
+    getDelayMap(configObj, delayMap);
+    auto clockPeriod = getClockPeriod(configObj);
 
     // Estimate performance and resource utilization. If any other functions are
     // called by the top function, it will be estimated in the procedure of
     // estimating the top function.
+    auto estimator =
+        ScaleHLSEstimator(latencyMap, dspUsageMap, lutUsageMap, ffUsageMap,
+                          axiMap, delayMap, clockPeriod, true);
+    estimator.setLoopResources(!reportJson.empty() || !reportText.empty());
+    IIBottleneckMap bottlenecks;
     for (auto func : module.getOps<func::FuncOp>())
-      if (hasTopFuncAttr(func))
-        ScaleHLSEstimator(latencyMap, dspUsageMap, true).estimateFunc(func);
+      if (hasTopFuncAttr(func)) {
+        estimator.estimateFunc(func);
+        estimator.materializeAttributes(module);
+        module.walk([&](Operation *op) {
+          if (!isa<func::FuncOp, AffineForOp>(op))
+            return;
+          if (auto bottleneck = estimator.getIIBottleneck(op))
+            bottlenecks[op] = bottleneck;
+        });
+      }
+
+    // Emit a remark for each pipelined function or loop missing its target II.
+    for (auto func : module.getOps<func::FuncOp>()) {
+      Optional<AsmState> state;
+      auto funcDirect = getFuncDirective(func);
+      auto funcIt = bottlenecks.find(func);
+      if (funcDirect && funcDirect.getPipeline() &&
+          funcIt != bottlenecks.end() &&
+          funcIt->second.kind != EstimatedIIBottleneck::Kind::Target) {
+        state.emplace(func);
+        func.emitRemark("achieved interval of ")
+            << funcIt->second.II << " misses the target interval of "
+            << funcDirect.getTargetInterval() << ", limited by the "
+            << getIIBottleneckDescription(funcIt->second, *state);
+      }
+
+      func.walk([&](AffineForOp loop) {
+        auto directive = getLoopDirective(loop);
+        auto it = bottlenecks.find(loop);
+        if (!directive || !directive.getPipeline() ||
+            it == bottlenecks.end() ||
+            it->second.kind == EstimatedIIBottleneck::Kind::Target)
+          return;
+        if (!state)
+          state.emplace(func);
+        loop.emitRemark("achieved II of ")
+            << it->second.II << " misses the target II of "
+            << directive.getTargetII() << ", limited by the "
+            << getIIBottleneckDescription(it->second, *state);
+      });
+    }
+
+    auto &depCache = estimator.getDependenceCache();
+    numDepQueries = depCache.getNumQueries();
+    numDepCacheHits = depCache.getNumHits();
+    numCalleeQueries = estimator.getNumCalleeQueries();
+    numCalleeHits = estimator.getNumCalleeHits();
+    numLoopScheduleQueries = estimator.getNumLoopScheduleQueries();
+    numLoopScheduleHits = estimator.getNumLoopScheduleHits();
+
+    // Write the QoR reports if required.
+    if (reportJson.empty() && reportText.empty())
+      return;
+    auto report = llvm::json::Value(getQoRReport(module, bottlenecks));
+    if (!reportJson.empty() &&
+        failed(writeQoRReport(reportJson, [&](raw_ostream &os) {
+          os << llvm::formatv("{0:2}", report) << "\n";
+        })))
+      return signalPassFailure();
+    if (!reportText.empty() &&
+        failed(writeQoRReport(reportText, [&](raw_ostream &os) {
+          printQoRReport(os, *report.getAsArray());
+        })))
+      return signalPassFailure();
   }
 };
 } // namespace
@@ -11,6 +11,7 @@
 #include "mlir/Dialect/Tosa/IR/TosaOps.h"
 #include "mlir/IR/Dominance.h"
 #include "mlir/Pass/PassManager.h"
+#include "mlir/Transforms/InliningUtils.h"
 #include "mlir/Transforms/Passes.h"
 #include "scalehls/Transforms/Passes.h"
 
@@ -43,11 +44,42 @@ bool scalehls::applyMemoryOpts(func::FuncOp func) {
   return true;
 }
 
+void scalehls::loadMemoryOptsDialects(MLIRContext *context) {
+  PassManager optPM(context, "func.func");
+  addMemoryOptsPipeline(optPM);
+  DialectRegistry registry;
+  optPM.getDependentDialects(registry);
+  context->appendDialectRegistry(registry);
+  for (auto name : registry.getDialectNames())
+    context->getOrLoadDialect(name);
+}
+
+/// Inline the callee into the call site and erase the call. The callee is
+/// erased as well if it has no other uses.
+bool scalehls::applyCalleeInlining(func::CallOp call) {
+  auto callee = SymbolTable::lookupNearestSymbolFrom<func::FuncOp>(
+      call, call.getCalleeAttr());
+  if (!callee || callee.isExternal())
+    return false;
+
+  // Inlining may fail if any operation in the callee is not inlinable.
+  InlinerInterface interface(call.getContext());
+  if (failed(inlineCall(interface, call, callee, &callee.getBody())))
+    return false;
+
+  auto module = callee->getParentOp();
+  call.erase();
+  if (SymbolTable::symbolKnownUseEmpty(callee, module))
+    callee.erase();
+  return true;
+}
+
 /// Apply optimization strategy to a loop band. The ancestor function is also
 /// passed in because the post-tiling optimizations have to take function as
 /// target, e.g. canonicalizer and array partition.
 bool scalehls::applyOptStrategy(AffineLoopBand &band, func::FuncOp func,
-                                FactorList tileList, unsigned targetII) {
+                                FactorList tileList, unsigned targetII,
+                                bool flatten) {
   // By design the input function must be the ancestor of the input loop band.
   if (!func->isProperAncestor(band.front()))
     return false;
@@ -57,7 +89,7 @@ bool scalehls::applyOptStrategy(AffineLoopBand &band, func::FuncOp func,
     return false;
 
   // Apply loop pipelining.
-  if (!applyLoopPipelining(band, band.size() - 1, targetII))
+  if (!applyLoopPipelining(band, band.size() - 1, targetII, flatten))
     return false;
 
   // Apply memory access optimizations and the best suitable array partition
@@ -70,20 +102,26 @@ bool scalehls::applyOptStrategy(AffineLoopBand &band, func::FuncOp func,
 /// Apply optimization strategy to a function.
 bool scalehls::applyOptStrategy(func::FuncOp func,
                                 ArrayRef<FactorList> tileLists,
-                                ArrayRef<unsigned> targetIIs) {
+                                ArrayRef<unsigned> targetIIs,
+                                ArrayRef<bool> flattens) {
   AffineLoopBands bands;
   getLoopBands(func.front(), bands);
   assert(bands.size() == tileLists.size() && bands.size() == targetIIs.size() &&
          "unexpected size of tile lists or target IIs");
+  assert((flattens.empty() || bands.size() == flattens.size()) &&
+         "unexpected size of flattens");
 
   // Apply loop tiling to all loop bands.
   for (unsigned i = 0, e = bands.size(); i < e; ++i)
     if (!applyLoopTiling(bands[i], tileLists[i]))
       return false;
 
-  for (unsigned i = 0, e = bands.size(); i < e; ++i)
-    if (!applyLoopPipelining(bands[i], bands[i].size() - 1, targetIIs[i]))
+  for (unsigned i = 0, e = bands.size(); i < e; ++i) {
+    auto flatten = flattens.empty() || flattens[i];
+    if (!applyLoopPipelining(bands[i], bands[i].size() - 1, targetIIs[i],
+                             flatten))
       return false;
+  }
 
   // Apply memory access optimizations and the best suitable array partition
   // strategy to the function.
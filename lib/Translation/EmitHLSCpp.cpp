@@ -255,6 +255,7 @@ public:
   /// SCF statement emitters.
   void emitScfFor(scf::ForOp op);
   void emitScfIf(scf::IfOp op);
+  void emitScfParallel(scf::ParallelOp op);
   void emitScfYield(scf::YieldOp op);
 
   /// Affine statement emitters.
@@ -433,7 +434,11 @@ public:
   /// SCF statements.
   bool visitOp(scf::ForOp op) { return emitter.emitScfFor(op), true; };
   bool visitOp(scf::IfOp op) { return emitter.emitScfIf(op), true; };
-  bool visitOp(scf::ParallelOp op) { return false; };
+  bool visitOp(scf::ParallelOp op) {
+    if (op.getNumResults())
+      return op.emitOpError("reduction is unsupported"), false;
+    return emitter.emitScfParallel(op), true;
+  };
   bool visitOp(scf::ReduceOp op) { return false; };
   bool visitOp(scf::ReduceReturnOp op) { return false; };
   bool visitOp(scf::YieldOp op) { return emitter.emitScfYield(op), true; };
@@ -896,6 +901,48 @@ void ModuleEmitter::emitScfIf(scf::IfOp op) {
   indent() << "}\n";
 }
 
+void ModuleEmitter::emitScfParallel(scf::ParallelOp op) {
+  for (unsigned i = 0, e = op.getNumLoops(); i < e; ++i) {
+    indent() << "for (";
+    auto iterVar = op.getInductionVars()[i];
+
+    // Emit lower bound.
+    emitValue(iterVar);
+    os << " = ";
+    emitValue(op.getLowerBound()[i]);
+    os << "; ";
+
+    // Emit upper bound.
+    emitValue(iterVar);
+    os << " < ";
+    emitValue(op.getUpperBound()[i]);
+    os << "; ";
+
+    // Emit increase step.
+    emitValue(iterVar);
+    os << " += ";
+    emitValue(op.getStep()[i]);
+    os << ") {";
+    emitInfoAndNewLine(op);
+
+    addIndent();
+
+    // Parallel loops are fully unrolled into replicas of the loop body if
+    // required or their trip counts are small, which is consistent with the
+    // QoR estimator.
+    if (isUnrolledParallelLoop(op))
+      indent() << "#pragma HLS unroll\n";
+  }
+
+  emitBlock(*op.getBody());
+
+  for (unsigned i = 0, e = op.getNumLoops(); i < e; ++i) {
+    reduceIndent();
+
+    indent() << "}\n";
+  }
+}
+
 void ModuleEmitter::emitScfYield(scf::YieldOp op) {
   if (op.getNumOperands() == 0)
     return;
@@ -1067,6 +1114,12 @@ void ModuleEmitter::emitAffineParallel(AffineParallelOp op) {
     emitInfoAndNewLine(op);
 
     addIndent();
+
+    // Parallel loops are fully unrolled into replicas of the loop body if
+    // required or their trip counts are small, which is consistent with the
+    // QoR estimator.
+    if (isUnrolledParallelLoop(op))
+      indent() << "#pragma HLS unroll\n";
   }
 
   emitBlock(*op.getBody());
@@ -1888,7 +1941,8 @@ void ModuleEmitter::emitFunction(func::FuncOp func) {
   if (auto resource = getResource(func)) {
     os << "/// DSP=" << resource.getDsp();
     os << ", BRAM=" << resource.getBram();
-    // os << ", LUT=" << resource.getLut();
+    os << ", LUT=" << resource.getLut();
+    os << ", FF=" << resource.getFf();
     os << "\n";
   }
 
@@ -0,0 +1,90 @@
+# REQUIRES: bindings_python
+# RUN: %PYTHON %s %S/../Transforms/Directive/config.json
+
+import sys
+import mlir.ir
+from mlir.dialects import func as func_dialect
+import scalehls
+
+MODULE = """
+module {
+  func.func @test_kernel(%arg0: memref<16x16xf32>, %arg1: memref<16x16xf32>,
+                         %arg2: f32, %arg3: f32) -> f32 {
+    affine.for %i = 0 to 16 {
+      affine.for %j = 0 to 16 {
+        %0 = affine.load %arg0[%i, %j] : memref<16x16xf32>
+        %1 = arith.mulf %0, %arg2 : f32
+        affine.store %1, %arg1[%i, %j] : memref<16x16xf32>
+      }
+    }
+    %2 = func.call @test_callee(%arg2, %arg3) : (f32, f32) -> f32
+    return %2 : f32
+  }
+
+  func.func @test_callee(%arg0: f32, %arg1: f32) -> f32 {
+    %0 = arith.addf %arg0, %arg1 : f32
+    return %0 : f32
+  }
+}
+"""
+
+ctx = mlir.ir.Context()
+scalehls.register_dialects(ctx)
+mod = mlir.ir.Module.parse(MODULE, ctx)
+func = mod.body.operations[0]
+func.__class__ = func_dialect.FuncOp
+
+estimator = scalehls.Estimator(sys.argv[1])
+
+# The function is estimated including its callee.
+results = estimator.estimate_func(func)
+assert set(results) == {"latency", "interval", "lut", "dsp", "bram", "ff"}
+assert results["latency"] > 0 and results["dsp"] >= 0
+
+bands = list(scalehls.LoopBandList(func))
+assert len(bands) == 1 and bands[0].depth == 2
+results = estimator.estimate_loop_band(bands[0], func)
+assert results["latency"] > 0 and results["interval"] > 0
+
+# Explore the design space of the loop band. The points are read-only views.
+space = scalehls.LoopDesignSpace(estimator, func, bands[0])
+space.initialize(4)
+space.explore(2)
+points = space.pareto_points
+all_points = space.all_points
+assert len(points) > 0 and len(all_points) >= len(points)
+assert points.dtype.names == ("latency", "dsp", "tile_config", "target_ii",
+                              "flatten")
+assert not points.flags.writeable
+tile_list = space.get_tile_list(int(points[0]["tile_config"]))
+assert len(tile_list) == 2
+
+# The design space can't be explored while any of its views is alive.
+try:
+    space.explore(1)
+    assert False, "exploring with alive views must fail"
+except RuntimeError:
+    pass
+del points, all_points
+space.explore(1)
+
+# Combine the loop design spaces into the design space of the function.
+func_space = scalehls.FuncDesignSpace(estimator, func, [space])
+func_space.combine()
+func_points = func_space.pareto_points
+assert len(func_points) > 0
+assert func_points.dtype.names == ("latency", "dsp")
+assert not func_points.flags.writeable
+
+index = int(func_points["latency"].argmin())
+loop_points = func_space.get_loop_points(index)
+assert len(loop_points) == 1
+assert not loop_points.flags.writeable
+
+try:
+    func_space.combine()
+    assert False, "combining with alive views must fail"
+except RuntimeError:
+    pass
+del loop_points
+func_space.combine()
@@ -40,6 +40,7 @@ func.func @test_affine_parallel(%arg0: memref<16xindex>) {
   // CHECK: for (int v10 = 0; v10 < 2; v10 += 1) {
   // CHECK:   for (int v11 = 0; v11 < 4; v11 += 2) {
   // CHECK:     for (int v12 = 0; v12 < 8; v12 += 3) {
+  // CHECK-NEXT:  #pragma HLS unroll
   %0:2 = affine.parallel (%x, %y, %z) = (0, 0, 0) to (2, 4, 8) step (1, 2, 3) reduce ("maxs", "addi") -> (index, index){
 
     // CHECK: int v13 = v7[v10];
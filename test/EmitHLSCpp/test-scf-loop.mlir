@@ -38,3 +38,41 @@ func.func @test_scf_for(%arg0: memref<16xindex>, %arg1: index) {
   }
   return
 }
+
+func.func @test_scf_parallel(%arg0: memref<16xindex>) {
+  %c0 = arith.constant 0 : index
+  %c2 = arith.constant 2 : index
+  %c16 = arith.constant 16 : index
+
+  // CHECK: for (int [[I:v[0-9]+]] = (int)0; [[I]] < (int)16; [[I]] += (int)2) {
+  // CHECK-NEXT: #pragma HLS unroll
+  scf.parallel (%i) = (%c0) to (%c16) step (%c2) {
+
+    // CHECK: {{\[}}[[I]]] = [[I]];
+    memref.store %i, %arg0[%i] : memref<16xindex>
+
+  // CHECK: }
+  }
+  return
+}
+
+func.func @test_scf_parallel_large(%arg0: memref<1024xindex>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c1024 = arith.constant 1024 : index
+
+  // Parallel loops with large trip counts are not unrolled unless required.
+  // CHECK: for (int [[I:v[0-9]+]] = (int)0; [[I]] < (int)1024; [[I]] += (int)1) {
+  // CHECK-NOT: #pragma HLS unroll
+  // CHECK: {{\[}}[[I]]] = [[I]];
+  scf.parallel (%i) = (%c0) to (%c1024) step (%c1) {
+    memref.store %i, %arg0[%i] : memref<1024xindex>
+  }
+
+  // CHECK: for (int [[J:v[0-9]+]] = (int)0; [[J]] < (int)1024; [[J]] += (int)1) {
+  // CHECK-NEXT: #pragma HLS unroll
+  scf.parallel (%j) = (%c0) to (%c1024) step (%c1) {
+    memref.store %j, %arg0[%j] : memref<1024xindex>
+  } {unroll}
+  return
+}
@@ -0,0 +1,23 @@
+// RUN: scalehls-opt -scalehls-profile-execution="top-func=test_profile" %s | FileCheck %s
+
+#map = affine_map<(d0) -> (d0)>
+#set = affine_set<(d0) : (d0 - 4 >= 0)>
+module {
+  // CHECK-LABEL: func.func @test_profile
+  func.func @test_profile(%arg0: memref<16xi32>) {
+    %c0_i32 = arith.constant 0 : i32
+    affine.for %arg1 = 0 to 16 {
+      affine.for %arg2 = 0 to #map(%arg1) {
+        %0 = affine.load %arg0[%arg2] : memref<16xi32>
+        affine.store %0, %arg0[%arg1] : memref<16xi32>
+      }
+      // CHECK: } {trip_count = 8 : i64}
+      affine.if #set(%arg1) {
+        affine.store %c0_i32, %arg0[%arg1] : memref<16xi32>
+      }
+      // CHECK: } {then_probability = 7.500000e-01 : f64}
+    }
+    // CHECK: } {trip_count = 16 : i64}
+    return
+  }
+}
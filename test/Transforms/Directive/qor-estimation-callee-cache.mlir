@@ -0,0 +1,26 @@
+// REQUIRES: asserts
+// RUN: scalehls-opt -scalehls-qor-estimation="target-spec=%S/config.json" -mlir-pass-statistics %s 2>&1 | FileCheck %s
+
+// The callee is only estimated for the first top function, and its results are
+// reused by the second one, as the callee is not changed in between.
+// CHECK-DAG: (S) 1 callee-cache-hits
+// CHECK-DAG: (S) 2 callee-queries
+
+module {
+  func.func @test_top0(%arg0: i32, %arg1: i32) -> i32 attributes {top_func} {
+    %0 = func.call @test_callee(%arg0, %arg1) : (i32, i32) -> i32
+    return %0 : i32
+  }
+
+  func.func @test_top1(%arg0: i32, %arg1: i32) -> i32 attributes {top_func} {
+    %0 = func.call @test_callee(%arg1, %arg0) : (i32, i32) -> i32
+    return %0 : i32
+  }
+
+  // CHECK: func.func @test_callee
+  // CHECK-SAME: timing = #hls.t<0 -> 4, 4, 4>}
+  func.func @test_callee(%arg0: i32, %arg1: i32) -> i32 {
+    %0 = arith.muli %arg0, %arg1 : i32
+    return %0 : i32
+  }
+}
@@ -0,0 +1,46 @@
+// REQUIRES: asserts
+// RUN: scalehls-opt -scalehls-qor-estimation="target-spec=%S/config.json" -mlir-pass-statistics %s 2>&1 | FileCheck %s
+
+// The two loops of the first function are identical, thus the schedule of the
+// one estimated first is replayed onto the other. The loops of the second
+// function only differ in an outer constant, thus are both scheduled.
+// CHECK-DAG: (S) 1 loop-schedule-hits
+// CHECK-DAG: (S) 4 loop-schedule-queries
+
+module {
+  // CHECK: func.func @test_identical_loops
+  // CHECK: affine.for
+  // CHECK: } {loop_info = [[INFO:#hls.l<[^>]*>]], {{.*}}timing = #hls.t<{{[0-9]+}} -> {{[0-9]+}}, [[TIMING:[0-9]+, [0-9]+]]>}
+  // CHECK: affine.for
+  // CHECK: } {loop_info = [[INFO]], {{.*}}timing = #hls.t<{{[0-9]+}} -> {{[0-9]+}}, [[TIMING]]>}
+  func.func @test_identical_loops(%arg0: memref<32xi32, 6>, %arg1: memref<32xi32, 6>, %arg2: memref<32xi32, 6>, %arg3: memref<32xi32, 6>) attributes {top_func} {
+    %c1_i32 = arith.constant 1 : i32
+    affine.for %arg4 = 0 to 32 {
+      %0 = affine.load %arg0[%arg4] : memref<32xi32, 6>
+      %1 = arith.addi %0, %c1_i32 : i32
+      affine.store %1, %arg1[%arg4] : memref<32xi32, 6>
+    }
+    affine.for %arg4 = 0 to 32 {
+      %0 = affine.load %arg2[%arg4] : memref<32xi32, 6>
+      %1 = arith.addi %0, %c1_i32 : i32
+      affine.store %1, %arg3[%arg4] : memref<32xi32, 6>
+    }
+    return
+  }
+
+  func.func @test_different_constants(%arg0: memref<32xi32, 6>, %arg1: memref<32xi32, 6>, %arg2: memref<32xi32, 6>, %arg3: memref<32xi32, 6>) attributes {top_func} {
+    %c1_i32 = arith.constant 1 : i32
+    %c2_i32 = arith.constant 2 : i32
+    affine.for %arg4 = 0 to 32 {
+      %0 = affine.load %arg0[%arg4] : memref<32xi32, 6>
+      %1 = arith.addi %0, %c1_i32 : i32
+      affine.store %1, %arg1[%arg4] : memref<32xi32, 6>
+    }
+    affine.for %arg4 = 0 to 32 {
+      %0 = affine.load %arg2[%arg4] : memref<32xi32, 6>
+      %1 = arith.addi %0, %c2_i32 : i32
+      affine.store %1, %arg3[%arg4] : memref<32xi32, 6>
+    }
+    return
+  }
+}
@@ -1,11 +1,12 @@
 // RUN: scalehls-opt -scalehls-qor-estimation="target-spec=%S/config.json" %s | FileCheck %s
+// RUN: scalehls-opt -scalehls-qor-estimation="target-spec=%S/config.json report-text=%t" %s && FileCheck %s --check-prefix=REPORT < %t
 
 #map0 = affine_map<(d0, d1) -> (0, d1 mod 2, d0, d1 floordiv 2)>
 #map1 = affine_map<(d0, d1) -> (0, 0, d0, d1)>
 #set0 = affine_set<(d0, d1) : (d0 - d1 >= 0)>
 #set1 = affine_set<(d0) : (d0 == 0)>
 module  {
-  // CHECK: attributes {func_directive = #hls.fd<pipeline=false, targetInterval=1, dataflow=false>, resource = #hls.r<lut=0, dsp=11, bram=0>, timing = #hls.t<0 -> 4119, 4119, 4119>, top_func}
+  // CHECK: attributes {func_directive = #hls.fd<pipeline=false, targetInterval=1, dataflow=false>, resource = #hls.r<lut=1594, dsp=11, bram=0, ff=669>, timing = #hls.t<0 -> 4119, 4119, 4119>, top_func}
   func.func @test_syrk(%arg0: f32, %arg1: f32, %arg2: memref<16x16xf32, #map0, 6>, %arg3: memref<16x16xf32, #map1, 6>) attributes {func_directive = #hls.fd<pipeline=false, targetInterval=1, dataflow=false>, top_func} {
     affine.for %arg4 = 0 to 16 step 2 {
       affine.for %arg5 = 0 to 16 {
@@ -35,4 +36,169 @@ module  {
     } {loop_directive = #hls.ld<pipeline=false, targetII=1, dataflow=false, flatten=true>}
     return
   }
+
+  // CHECK: attributes {resource = #hls.r<lut=20, dsp=3, bram=0, ff=165>, timing = #hls.t<0 -> 4, 4, 4>, top_func}
+  func.func @test_muli(%arg0: i32, %arg1: i32) -> i32 attributes {top_func} {
+    %0 = arith.muli %arg0, %arg1 : i32
+    return %0 : i32
+  }
+
+  // CHECK: attributes {resource = #hls.r<lut=192, dsp=0, bram=0, ff=0>, timing = #hls.t<0 -> 4, 4, 4>, top_func}
+  func.func @test_chain(%arg0: i32, %arg1: i32) -> i32 attributes {top_func} {
+    %0 = arith.addi %arg0, %arg1 : i32
+    %1 = arith.addi %0, %arg1 : i32
+    %2 = arith.addi %1, %arg1 : i32
+    %3 = arith.addi %2, %arg1 : i32
+    %4 = arith.addi %3, %arg1 : i32
+    %5 = arith.addi %4, %arg1 : i32
+    return %5 : i32
+  }
+
+  // CHECK: attributes {resource = #hls.r<lut=26, dsp=0, bram=2, ff=16>, timing = #hls.t<0 -> 106, 106, 52>, top_func}
+  func.func @test_dataflow(%arg0: memref<16xi32, 6>, %arg1: memref<16xi32, 6>) attributes {top_func} {
+    hls.dataflow.schedule(%arg0, %arg1) : memref<16xi32, 6>, memref<16xi32, 6> {
+    ^bb0(%arg2: memref<16xi32, 6>, %arg3: memref<16xi32, 6>):
+      %0 = hls.dataflow.buffer {depth = 2 : i32} : memref<16xi32, 6>
+      // CHECK: hls.dataflow.node
+      // CHECK: timing = #hls.t<0 -> 52, 52, 52>
+      hls.dataflow.node(%arg2) -> (%0) {inputTaps = [0 : i32]} : (memref<16xi32, 6>) -> memref<16xi32, 6> {
+      ^bb0(%arg4: memref<16xi32, 6>, %arg5: memref<16xi32, 6>):
+        affine.for %arg6 = 0 to 16 {
+          %1 = affine.load %arg4[%arg6] : memref<16xi32, 6>
+          affine.store %1, %arg5[%arg6] : memref<16xi32, 6>
+        }
+      }
+      // CHECK: hls.dataflow.node
+      // CHECK: timing = #hls.t<52 -> 104, 52, 52>
+      hls.dataflow.node(%0) -> (%arg3) {inputTaps = [0 : i32]} : (memref<16xi32, 6>) -> memref<16xi32, 6> {
+      ^bb0(%arg4: memref<16xi32, 6>, %arg5: memref<16xi32, 6>):
+        affine.for %arg6 = 0 to 16 {
+          %1 = affine.load %arg4[%arg6] : memref<16xi32, 6>
+          affine.store %1, %arg5[%arg6] : memref<16xi32, 6>
+        }
+      }
+    }
+    return
+  }
+
+  // The schedule is started after the multiplication, thus the levels of nodes
+  // are offset by the latency of the multiplication.
+  // CHECK: timing = #hls.t<0 -> 108, 108, {{[0-9]+}}>, top_func}
+  func.func @test_dataflow_offset(%arg0: memref<16xi32, 6>, %arg1: memref<16xi32, 6>, %arg2: i32, %arg3: i32) attributes {top_func} {
+    %0 = arith.muli %arg2, %arg3 : i32
+    hls.dataflow.schedule(%arg0, %arg1, %0) : memref<16xi32, 6>, memref<16xi32, 6>, i32 {
+    ^bb0(%arg4: memref<16xi32, 6>, %arg5: memref<16xi32, 6>, %arg6: i32):
+      %1 = hls.dataflow.buffer {depth = 2 : i32} : memref<16xi32, 6>
+      // CHECK: hls.dataflow.node
+      // CHECK: timing = #hls.t<2 -> 54, 52, 52>
+      hls.dataflow.node(%arg4) -> (%1) {inputTaps = [0 : i32]} : (memref<16xi32, 6>) -> memref<16xi32, 6> {
+      ^bb0(%arg7: memref<16xi32, 6>, %arg8: memref<16xi32, 6>):
+        affine.for %arg9 = 0 to 16 {
+          %2 = affine.load %arg7[%arg9] : memref<16xi32, 6>
+          affine.store %2, %arg8[%arg9] : memref<16xi32, 6>
+        }
+      }
+      // CHECK: hls.dataflow.node
+      // CHECK: timing = #hls.t<54 -> 106, 52, 52>
+      hls.dataflow.node(%1) -> (%arg5) {inputTaps = [0 : i32]} : (memref<16xi32, 6>) -> memref<16xi32, 6> {
+      ^bb0(%arg7: memref<16xi32, 6>, %arg8: memref<16xi32, 6>):
+        affine.for %arg9 = 0 to 16 {
+          %2 = affine.load %arg7[%arg9] : memref<16xi32, 6>
+          affine.store %2, %arg8[%arg9] : memref<16xi32, 6>
+        }
+      }
+    }
+    return
+  }
+
+  // CHECK: timing = #hls.t<0 -> 130, 130, 130>, top_func}
+  // REPORT: == Function: test_axi
+  // REPORT: | Latency | Interval |
+  // REPORT: | 130 {{ *}}| 130 {{ *}}|
+  // REPORT: | - Loop 1 {{ *}}| 128 {{ *}}| 66 {{ *}}| 4 {{ *}}| 1 {{ *}}| bandwidth of the AXI bundle of %arg0 {{ *}}| 16 {{ *}}| yes {{ *}}| no {{ *}}|
+  func.func @test_axi(%arg0: memref<32xi32, 12>, %arg1: memref<16xi32, 6>) attributes {top_func} {
+    affine.for %arg2 = 0 to 16 {
+      %0 = affine.load %arg0[%arg2 * 2] : memref<32xi32, 12>
+      affine.store %0, %arg1[%arg2] : memref<16xi32, 6>
+    } {loop_directive = #hls.ld<pipeline=true, targetII=1, dataflow=false, flatten=false>}
+    return
+  }
+
+  // CHECK: timing = #hls.t<0 -> 52, 52, 52>, top_func}
+  func.func @test_scf_for(%arg0: memref<16xi32, 6>) attributes {top_func} {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c16 = arith.constant 16 : index
+    scf.for %arg1 = %c0 to %c16 step %c1 {
+      %0 = memref.load %arg0[%arg1] : memref<16xi32, 6>
+      memref.store %0, %arg0[%arg1] : memref<16xi32, 6>
+    }
+    return
+  }
+
+  // CHECK: timing = #hls.t<0 -> 12, 12, 12>, top_func}
+  func.func @test_parallel(%arg0: memref<8xi32, 6>, %arg1: memref<8xi32, 6>) attributes {top_func} {
+    affine.parallel (%arg2) = (0) to (8) {
+      %0 = affine.load %arg0[%arg2] : memref<8xi32, 6>
+      affine.store %0, %arg1[%arg2] : memref<8xi32, 6>
+    }
+    return
+  }
+
+  // CHECK: timing = #hls.t<0 -> 6, 6, 4>, top_func}
+  func.func @test_func_pipeline(%arg0: i32, %arg1: i32) -> i32 attributes {func_directive = #hls.fd<pipeline=true, targetInterval=1, dataflow=false>, top_func} {
+    %0 = func.call @test_callee(%arg0, %arg1) : (i32, i32) -> i32
+    return %0 : i32
+  }
+
+  func.func @test_callee(%arg0: i32, %arg1: i32) -> i32 {
+    %0 = arith.muli %arg0, %arg1 : i32
+    return %0 : i32
+  }
+
+  // Only the read/write port of a RAM_2P memory can be written, thus two
+  // writes to the same partition require an II of 2.
+  // REPORT: == Function: test_ram_2p
+  // REPORT: | - Loop 1 {{ *}}| {{[0-9]+ *}}| {{[0-9]+ *}}| 2 {{ *}}| 1 {{ *}}| ports of partition 0 of {{.*}}| 8 {{ *}}| yes {{ *}}| no {{ *}}|
+  func.func @test_ram_2p(%arg0: memref<16xi32, 5>, %arg1: i32) attributes {top_func} {
+    affine.for %arg2 = 0 to 8 {
+      affine.store %arg1, %arg0[%arg2 * 2] : memref<16xi32, 5>
+      affine.store %arg1, %arg0[%arg2 * 2 + 1] : memref<16xi32, 5>
+    } {loop_directive = #hls.ld<pipeline=true, targetII=1, dataflow=false, flatten=false>}
+    return
+  }
+
+  // Loops are never overlapped, thus the multiplications of the two loops are
+  // bound to one multiplier, which saves 3 DSPs at the cost of 64 LUTs of input
+  // multiplexers. Each loop holds 12 LUTs and 7 FFs of control logic.
+  // CHECK: attributes {resource = #hls.r<lut=108, dsp=3, bram=0, ff=179>, timing = #hls.t<0 -> 70, 70, 70>, top_func}
+  func.func @test_share_loops(%arg0: i32, %arg1: i32) attributes {top_func} {
+    affine.for %arg2 = 0 to 16 {
+      %0 = arith.muli %arg0, %arg1 : i32
+    }
+    affine.for %arg2 = 0 to 16 {
+      %0 = arith.muli %arg0, %arg1 : i32
+    }
+    return
+  }
+
+  // The two calls are not overlapped, thus share one instance of the callee
+  // with 64 LUTs of argument multiplexers.
+  // CHECK: attributes {resource = #hls.r<lut=84, dsp=3, bram=0, ff=165>, timing = #hls.t<0 -> 10, 10, 10>, top_func}
+  func.func @test_share_calls(%arg0: i32, %arg1: i32) -> i32 attributes {top_func} {
+    %0 = func.call @test_callee(%arg0, %arg1) : (i32, i32) -> i32
+    %1 = func.call @test_callee(%0, %arg1) : (i32, i32) -> i32
+    return %1 : i32
+  }
+
+  // Calls in a pipelined loop are never shared, even if they are not
+  // overlapped in an iteration.
+  // CHECK: attributes {resource = #hls.r<lut={{[0-9]+}}, dsp=6, bram=0, ff={{[0-9]+}}>, timing = {{.*}}, top_func}
+  func.func @test_pipeline_calls(%arg0: i32, %arg1: i32) attributes {top_func} {
+    affine.for %arg2 = 0 to 16 {
+      %0 = func.call @test_callee(%arg0, %arg1) : (i32, i32) -> i32
+      %1 = func.call @test_callee(%0, %arg1) : (i32, i32) -> i32
+    } {loop_directive = #hls.ld<pipeline=true, targetII=1, dataflow=false, flatten=false>}
+    return
+  }
 }
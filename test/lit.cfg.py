@@ -81,3 +81,6 @@ llvm_config.add_tool_substitutions(tools, tool_dirs)
 
 if config.enable_bindings_python:
   config.available_features.add('bindings_python')
+
+if config.enable_assertions:
+  config.available_features.add('asserts')
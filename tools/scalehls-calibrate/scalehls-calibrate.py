@@ -0,0 +1,488 @@
+#!/usr/bin/env python3
+
+# Calibrate the target spec of the ScaleHLS QoR estimator against C synthesis
+# reports (csynth.xml) of Vivado/Vitis HLS. Each report is paired with the MLIR
+# of the synthesized design, which is estimated with "scalehls-opt" under the
+# base target spec. The following entries are fitted and written to a new
+# target spec:
+#   - Clock period, clock uncertainty, and available resources of the device.
+#   - Latencies of operators, by minimizing the error of the estimated pipeline
+#     depths and overall latencies with a coordinate descent.
+#   - DSP, LUT, and FF usages of operators, by a regularized least-squares fit
+#     of the reported resource utilization over the operator instances.
+#   - Entering, leaving, and iteration overheads of loops.
+
+
+import argparse
+import copy
+import json
+import os
+import re
+import statistics
+import sys
+import tempfile
+import xml.etree.ElementTree as ET
+from subprocess import PIPE, run
+import numpy as np
+
+
+INT_BIT_WIDTHS = [8, 16, 32, 64]
+
+# Operators that are profiled in the target spec, which must be consistent with
+# the operator handlers of the estimator.
+FLOAT_OPERATORS = {
+    'arith.addf': 'fadd', 'arith.subf': 'fadd', 'arith.mulf': 'fmul',
+    'arith.divf': 'fdiv', 'arith.cmpf': 'fcmp', 'math.exp': 'fexp',
+}
+
+INT_OPERATORS = {
+    'arith.addi': 'add', 'arith.subi': 'add', 'arith.muli': 'mul',
+    'arith.divsi': 'div', 'arith.divui': 'div', 'arith.remsi': 'rem',
+    'arith.remui': 'rem', 'arith.cmpi': 'cmp', 'arith.shli': 'shift',
+    'arith.shrsi': 'shift', 'arith.shrui': 'shift', 'arith.andi': 'logic',
+    'arith.ori': 'logic', 'arith.xori': 'logic', 'arith.maxsi': 'minmax',
+    'arith.minsi': 'minmax', 'arith.maxui': 'minmax', 'arith.minui': 'minmax',
+    'arith.select': 'select', 'arith.trunci': 'cast', 'arith.extui': 'cast',
+    'arith.extsi': 'cast', 'arith.index_cast': 'cast', 'hls.prim.cast': 'cast',
+}
+
+OPERATOR_REGEX = re.compile(r'=\s*"?([a-z_]+\.[a-z_.]+)"?[\s(]')
+INT_TYPE_REGEX = re.compile(r'\b(?:i(\d+)|(index))\b')
+VECTOR_REGEX = re.compile(r'vector<(\d+)x')
+TIMING_REGEX = re.compile(r'timing = #hls\.t<(\d+) -> (\d+), (\d+), (\d+)>')
+RESOURCE_REGEX = re.compile(
+    r'resource = #hls\.r<lut=(\d+), dsp=(\d+), bram=(\d+), ff=(\d+)>')
+LOOP_INFO_REGEX = re.compile(
+    r'loop_info = #hls\.l<flattenTripCount=(\d+), iterLatency=(\d+), '
+    r'minII=(\d+)>')
+
+
+def do_run(command):
+    ret = run(command, stdout=PIPE, stderr=PIPE, universal_newlines=True)
+    if ret.returncode:
+        raise RuntimeError(' '.join(command) + ' failed:\n' + ret.stderr)
+    return ret.stdout
+
+
+def get_int_operator_key(name, bit_width):
+    for width in INT_BIT_WIDTHS:
+        if bit_width <= width:
+            return name + '_' + str(width)
+    return name + '_' + str(INT_BIT_WIDTHS[-1])
+
+
+def split_int_operator_key(key):
+    name, _, width = key.rpartition('_')
+    if name and width in map(str, INT_BIT_WIDTHS):
+        return name, width
+    return key, None
+
+
+#===----------------------------------------------------------------------===#
+# Synthesis Report Parsing
+#===----------------------------------------------------------------------===#
+
+def get_number(node, path, number_type=int):
+    """Return the number held by the child at "path", where the maximum is taken
+    if the number is reported as a range. Return None if it is not available,
+    such as "undef" or "-"."""
+    child = node.find(path) if node is not None else None
+    if child is None:
+        return None
+    if child.find('range/max') is not None:
+        child = child.find('range/max')
+    try:
+        return number_type(child.text)
+    except (TypeError, ValueError):
+        return None
+
+
+def get_resources(node):
+    if node is None:
+        return {}
+    dsp = get_number(node, 'DSP48E')
+    return {
+        'dsp': dsp if dsp is not None else get_number(node, 'DSP'),
+        'lut': get_number(node, 'LUT'),
+        'ff': get_number(node, 'FF'),
+        'bram': get_number(node, 'BRAM_18K'),
+    }
+
+
+def parse_report(path):
+    root = ET.parse(path).getroot()
+    assignments = root.find('UserAssignments')
+    perf = root.find('PerformanceEstimates')
+    area = root.find('AreaEstimates')
+
+    # Collect the loops in a pre-order, where each loop is reported with its
+    # nested loops as children.
+    loops = []
+
+    def collect_loops(node):
+        for child in node:
+            if child.find('TripCount') is None:
+                continue
+            loops.append({
+                'trip_count': get_number(child, 'TripCount'),
+                'latency': get_number(child, 'Latency'),
+                'iter_latency': get_number(child, 'IterationLatency'),
+                'ii': get_number(child, 'PipelineII'),
+                'depth': get_number(child, 'PipelineDepth'),
+            })
+            collect_loops(child)
+
+    if perf is not None and perf.find('SummaryOfLoopLatency') is not None:
+        collect_loops(perf.find('SummaryOfLoopLatency'))
+
+    overall = perf.find('SummaryOfOverallLatency') if perf is not None else None
+    return {
+        'clock_period': get_number(assignments, 'TargetClockPeriod', float),
+        'clock_uncertainty': get_number(assignments, 'ClockUncertainty',
+                                        float),
+        'latency': get_number(overall, 'Worst-caseLatency'),
+        'interval': get_number(overall, 'Interval-max'),
+        'resources': get_resources(area.find('Resources')
+                                   if area is not None else None),
+        'available': get_resources(area.find('AvailableResources')
+                                   if area is not None else None),
+        'loops': loops,
+    }
+
+
+#===----------------------------------------------------------------------===#
+# MLIR Parsing and Estimation
+#===----------------------------------------------------------------------===#
+
+def count_operators(mlir):
+    """Count the operator instances of the design, which are keyed in the same
+    way as the target spec."""
+    counts = {}
+    for line in mlir.splitlines():
+        match = OPERATOR_REGEX.search(line)
+        if not match:
+            continue
+        op_name = match.group(1)
+
+        # Count vectorized operators with their number of elements.
+        vector = VECTOR_REGEX.search(line)
+        num = int(vector.group(1)) if vector else 1
+
+        if op_name in FLOAT_OPERATORS:
+            key = FLOAT_OPERATORS[op_name]
+        elif op_name == 'hls.prim.mul':
+            key = 'prim_mul'
+        elif op_name in INT_OPERATORS:
+            bit_width = 1
+            for width, index in INT_TYPE_REGEX.findall(line.rpartition(':')[2]):
+                bit_width = max(bit_width, 32 if index else int(width))
+            key = get_int_operator_key(INT_OPERATORS[op_name], bit_width)
+        else:
+            continue
+        counts[key] = counts.get(key, 0) + num
+    return counts
+
+
+def parse_estimation(mlir):
+    """Return the estimated results of the top function, and of the loops in the
+    top function in a pre-order. Loops flattened into their child loops are
+    excluded, as they are merged into one loop by the HLS tool as well."""
+    result = {'latency': None, 'interval': None, 'resources': {}, 'loops': []}
+    in_top_func = False
+    regions = []
+
+    for line in mlir.splitlines():
+        stripped = line.strip()
+        if stripped.startswith('func.func'):
+            in_top_func = 'top_func' in stripped
+            if in_top_func:
+                timing = TIMING_REGEX.search(stripped)
+                resource = RESOURCE_REGEX.search(stripped)
+                if timing:
+                    result['latency'] = int(timing.group(3))
+                    result['interval'] = int(timing.group(4))
+                if resource:
+                    lut, dsp, bram, ff = map(int, resource.groups())
+                    result['resources'] = {'lut': lut, 'dsp': dsp,
+                                           'bram': bram, 'ff': ff}
+            continue
+        if not in_top_func:
+            continue
+
+        # Loop attributes are printed on the line closing the loop body.
+        if stripped.startswith('}') and regions:
+            loop = regions.pop()
+            if loop is not None:
+                loop_info = LOOP_INFO_REGEX.search(stripped)
+                timing = TIMING_REGEX.search(stripped)
+                loop['flatten'] = 'flatten=true' in stripped
+                loop['pipeline'] = 'pipeline=true' in stripped
+                if loop_info:
+                    loop['trip_count'] = int(loop_info.group(1))
+                    loop['iter_latency'] = int(loop_info.group(2))
+                    loop['ii'] = int(loop_info.group(3))
+                if timing:
+                    loop['latency'] = int(timing.group(3))
+        if stripped.endswith('{'):
+            if stripped.startswith('affine.for'):
+                loop = {}
+                result['loops'].append(loop)
+                regions.append(loop)
+            else:
+                regions.append(None)
+
+    result['loops'] = [loop for loop in result['loops']
+                       if not loop.get('flatten') and 'latency' in loop]
+    return result
+
+
+def estimate(designs, config, opt):
+    with tempfile.NamedTemporaryFile('w', suffix='.json', delete=False) as f:
+        json.dump(config, f)
+    try:
+        return [parse_estimation(do_run(
+            [opt, design['mlir_path'],
+             '-scalehls-qor-estimation=target-spec=' + f.name]))
+            for design in designs]
+    finally:
+        os.remove(f.name)
+
+
+def get_matched_loops(design, estimation):
+    """Match the estimated loops with the reported loops in a pre-order. The
+    loops are not used if the loop structures are different."""
+    reported, estimated = design['report']['loops'], estimation['loops']
+    if len(reported) != len(estimated):
+        return []
+    return list(zip(reported, estimated))
+
+
+#===----------------------------------------------------------------------===#
+# Target Spec Fitting
+#===----------------------------------------------------------------------===#
+
+def get_relative_error(estimated, reported):
+    if estimated is None or reported is None:
+        return 0.0
+    return abs(estimated - reported) / max(reported, 1)
+
+
+def get_latency_error(designs, estimations):
+    error = 0.0
+    for design, estimation in zip(designs, estimations):
+        error += get_relative_error(estimation['latency'],
+                                    design['report']['latency'])
+        for reported, estimated in get_matched_loops(design, estimation):
+            if reported['depth'] is not None and estimated.get('pipeline'):
+                error += get_relative_error(estimated['iter_latency'],
+                                            reported['depth'])
+    return error
+
+
+def get_median_overhead(samples, default):
+    samples = [sample for sample in samples if sample is not None]
+    return max(int(round(statistics.median(samples))), 0) if samples \
+        else default
+
+
+def fit_report_overheads(designs, latency_map):
+    """Fit the overheads of entering and leaving loops, which are derived from
+    the reported loops only."""
+    pipelined, sequential = [], []
+    for design in designs:
+        for loop in design['report']['loops']:
+            if None in (loop['latency'], loop['trip_count']):
+                continue
+            if loop['ii'] is not None and loop['depth'] is not None:
+                pipelined.append(loop['latency'] - loop['depth'] -
+                                 loop['ii'] * (loop['trip_count'] - 1))
+            elif loop['iter_latency'] is not None:
+                sequential.append(loop['latency'] -
+                                  loop['iter_latency'] * loop['trip_count'])
+
+    latency_map['pipeline_overhead'] = get_median_overhead(
+        pipelined, latency_map.get('pipeline_overhead', 2))
+    latency_map['loop_overhead'] = get_median_overhead(
+        sequential, latency_map.get('loop_overhead', 2))
+
+
+def fit_iter_overhead(designs, estimations, latency_map):
+    """Fit the overhead of each iteration of sequential loops, which is the gap
+    between the reported and estimated iteration latencies."""
+    overhead = latency_map.get('loop_iter_overhead', 0)
+    samples = []
+    for design, estimation in zip(designs, estimations):
+        for reported, estimated in get_matched_loops(design, estimation):
+            if reported['ii'] is None and not estimated.get('pipeline') and \
+                    reported['iter_latency'] is not None and \
+                    'iter_latency' in estimated:
+                samples.append(reported['iter_latency'] -
+                               estimated['iter_latency'] + overhead)
+    latency_map['loop_iter_overhead'] = get_median_overhead(samples, overhead)
+
+
+def fit_latencies(designs, config, latency_map, keys, opt, max_iter_num):
+    """Fit the operator latencies with a coordinate descent, where each latency
+    is searched in a window around its current value while the others are
+    fixed."""
+    def evaluate():
+        return get_latency_error(designs, estimate(designs, config, opt))
+
+    best_error = evaluate()
+    for iteration in range(max_iter_num):
+        changed = False
+        for key in keys:
+            current = get_cost(latency_map, key)
+            best_latency = current
+            for latency in range(0, max(current * 2, current + 4) + 1):
+                if latency == current:
+                    continue
+                set_cost(latency_map, key, latency)
+                error = evaluate()
+                if error < best_error:
+                    best_error, best_latency = error, latency
+            set_cost(latency_map, key, best_latency)
+            changed |= best_latency != current
+        print('iteration {}: latency error {:.4f}'.format(iteration,
+                                                          best_error),
+              file=sys.stderr)
+        if not changed:
+            break
+
+
+def fit_usages(designs, usage_map, resource, regularization):
+    """Fit the usage of each operator with a least-squares fit regularized
+    towards the current usages, such that operators rarely seen in the reports
+    keep their original usages. Usages not specified in the target spec are
+    regularized towards zero, as the defaults of the estimator are not known
+    here."""
+    samples = [design for design in designs
+               if design['report']['resources'].get(resource) is not None]
+    keys = sorted({key for design in samples for key in design['counts']})
+    if not keys:
+        return
+
+    a = np.array([[design['counts'].get(key, 0) for key in keys]
+                  for design in samples], dtype=float)
+    b = np.array([design['report']['resources'][resource]
+                  for design in samples], dtype=float)
+    prior = np.array([get_cost(usage_map, key) for key in keys], dtype=float)
+
+    lhs = a.T @ a + regularization * np.eye(len(keys))
+    rhs = a.T @ b + regularization * prior
+    usages = np.clip(np.linalg.solve(lhs, rhs), 0, None)
+    for key, usage in zip(keys, usages):
+        set_cost(usage_map, key, int(round(usage)))
+
+
+#===----------------------------------------------------------------------===#
+# Target Spec Accessors
+#===----------------------------------------------------------------------===#
+
+def get_cost(costs, key, default=0):
+    name, width = split_int_operator_key(key)
+    cost = costs.get(name if width else key, default)
+    if isinstance(cost, dict):
+        return cost.get(width, default)
+    return cost
+
+
+def set_cost(costs, key, value):
+    name, width = split_int_operator_key(key)
+    if not width:
+        costs[key] = value
+        return
+
+    # Integer operators are specified for each bit width once calibrated, where
+    # missing bit widths fall back to the defaults of the estimator.
+    cost = costs.get(name, {})
+    if not isinstance(cost, dict):
+        cost = {str(w): cost for w in INT_BIT_WIDTHS}
+    cost[width] = value
+    costs[name] = cost
+
+
+def main():
+    parser = argparse.ArgumentParser(prog='scalehls-calibrate')
+    parser.add_argument('-i', dest='designs',
+                        metavar=('mlir', 'report'),
+                        nargs=2, action='append', required=True,
+                        help='MLIR of a synthesized design and its csynth.xml')
+    parser.add_argument('-c', dest='config',
+                        metavar='config',
+                        required=True,
+                        help='Base target spec json file')
+    parser.add_argument('-o', dest='output',
+                        metavar='output',
+                        required=True,
+                        help='Calibrated target spec json file')
+    parser.add_argument('--scalehls-opt', dest='opt',
+                        metavar='path',
+                        default='scalehls-opt',
+                        help='Path to scalehls-opt')
+    parser.add_argument('--max-iter-num', dest='max_iter_num',
+                        type=int, default=3,
+                        help='Maximum iteration number of the latency fitting')
+    parser.add_argument('--regularization', dest='regularization',
+                        type=float, default=1.0,
+                        help='Regularization of the resource usage fitting')
+
+    # Parse command line arguments.
+    opts = parser.parse_args()
+
+    with open(opts.config) as f:
+        config = json.load(f)
+
+    designs = []
+    for mlir_path, report_path in opts.designs:
+        with open(mlir_path) as f:
+            counts = count_operators(f.read())
+        designs.append({'mlir_path': mlir_path, 'counts': counts,
+                        'report': parse_report(report_path)})
+
+    # Calibrate the clock and the available resources of the device. All
+    # reports are expected to target the same device and clock.
+    report = designs[0]['report']
+    latency_map = config.get(config.get('frequency', '100MHz'), {})
+    if report['clock_period']:
+        frequency = '{:g}MHz'.format(round(1000 / report['clock_period'], 3))
+        latency_map = copy.deepcopy(config.get(frequency, latency_map))
+        config['frequency'] = frequency
+        config[frequency] = latency_map
+        config['clock_period'] = report['clock_period']
+        if report['clock_uncertainty'] is not None:
+            config['clock_uncertainty'] = report['clock_uncertainty']
+    for resource, available in report['available'].items():
+        if available is not None:
+            config[resource] = available
+
+    # Calibrate the resource usages of operators before the estimation, as the
+    # resource utilization doesn't change the scheduling.
+    for resource in ['dsp', 'lut', 'ff']:
+        usage_map = config.setdefault(resource + '_usage', {})
+        fit_usages(designs, usage_map, resource, opts.regularization)
+
+    # Calibrate the latencies of operators and the overheads of loops.
+    fit_report_overheads(designs, latency_map)
+    keys = sorted({key for design in designs for key in design['counts']})
+    fit_latencies(designs, config, latency_map, keys, opts.opt,
+                  opts.max_iter_num)
+    fit_iter_overhead(designs, estimate(designs, config, opts.opt),
+                      latency_map)
+
+    # Report the final estimation error of each design.
+    for design, estimation in zip(designs,
+                                  estimate(designs, config, opts.opt)):
+        print('{}: latency {} (reported {}), dsp {} (reported {})'.format(
+            design['mlir_path'], estimation['latency'],
+            design['report']['latency'],
+            estimation['resources'].get('dsp'),
+            design['report']['resources'].get('dsp')), file=sys.stderr)
+
+    with open(opts.output, 'w') as f:
+        json.dump(config, f, indent=4)
+        f.write('\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,294 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2020-2021 The ScaleHLS Authors.
+//
+//===----------------------------------------------------------------------===//
+//
+// This tool measures the speed of the QoR estimator, which is in the inner loop
+// of the design space exploration. Each input MLIR file is estimated with
+// ScaleHLSEstimator::estimateFunc(), ScaleHLSEstimator::estimateLoop(), and the
+// whole QoR estimation pass repeatedly. The time and the number of heap
+// allocations per call are reported, along with the peak resident set size of
+// the process after each benchmark. Note that the peak is never decreased, thus
+// a benchmark only raises it if it requires more memory than all previous ones.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "scalehls/InitAllDialects.h"
+#include "scalehls/Transforms/Estimator.h"
+#include "scalehls/Transforms/Passes.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace mlir;
+using namespace scalehls;
+
+//===----------------------------------------------------------------------===//
+// Allocation Counting
+//===----------------------------------------------------------------------===//
+
+// Count the heap allocations made through the global operator new, which is
+// used by most of the containers of LLVM and MLIR. Allocations made directly
+// with malloc, e.g., the growth of SmallVector, are not counted.
+static std::atomic<uint64_t> numAllocations(0);
+
+void *operator new(size_t size) {
+  numAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto ptr = std::malloc(size ? size : 1))
+    return ptr;
+  llvm::report_bad_alloc_error("allocation failed");
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+/// Return the peak resident set size of the process in bytes, or zero if it is
+/// not available on the host.
+static uint64_t getPeakRss() {
+#ifdef LLVM_ON_UNIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage))
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
+//===----------------------------------------------------------------------===//
+// Command Line Options
+//===----------------------------------------------------------------------===//
+
+static llvm::cl::list<std::string>
+    inputFilenames(llvm::cl::Positional, llvm::cl::OneOrMore,
+                   llvm::cl::desc("<input mlir files>"));
+
+static llvm::cl::opt<std::string>
+    targetSpec("target-spec", llvm::cl::init("./config.json"),
+               llvm::cl::desc("Target backend specifications and "
+                              "configurations"));
+
+static llvm::cl::opt<std::string>
+    topFuncName("top-func", llvm::cl::init(""),
+                llvm::cl::desc("The top function to be estimated if no "
+                               "function is annotated as top function"));
+
+static llvm::cl::opt<unsigned>
+    numIterations("iterations", llvm::cl::init(10),
+                  llvm::cl::desc("Number of times each benchmark is run"));
+
+//===----------------------------------------------------------------------===//
+// Benchmark Runner
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// The target configurations shared by all estimators.
+struct TargetSpec {
+  llvm::StringMap<int64_t> latencyMap;
+  llvm::StringMap<int64_t> dspUsageMap;
+  llvm::StringMap<int64_t> lutUsageMap;
+  llvm::StringMap<int64_t> ffUsageMap;
+  llvm::StringMap<int64_t> axiMap;
+  llvm::StringMap<double> delayMap;
+  double clockPeriod = 0;
+
+  ScaleHLSEstimator createEstimator() {
+    return ScaleHLSEstimator(latencyMap, dspUsageMap, lutUsageMap, ffUsageMap,
+                             axiMap, delayMap, clockPeriod, true);
+  }
+};
+
+/// The measured results of a benchmark.
+struct BenchResult {
+  std::string name;
+  uint64_t numCalls = 0;
+  double microseconds = 0;
+  uint64_t numAllocations = 0;
+  uint64_t peakRss = 0;
+};
+} // namespace
+
+static LogicalResult loadTargetSpec(StringRef filename, TargetSpec &spec) {
+  auto buffer = llvm::MemoryBuffer::getFile(filename);
+  if (!buffer) {
+    llvm::errs() << "failed to read the target spec json file\n";
+    return failure();
+  }
+  auto config = llvm::json::parse(buffer.get()->getBuffer());
+  if (!config) {
+    llvm::errs() << "failed to parse the target spec json file\n";
+    return failure();
+  }
+  auto configObj = config.get().getAsObject();
+  if (!configObj) {
+    llvm::errs() << "support an object in the target spec json file, found "
+                    "something else\n";
+    return failure();
+  }
+
+  getLatencyMap(configObj, spec.latencyMap);
+  getDspUsageMap(configObj, spec.dspUsageMap);
+  getLutUsageMap(configObj, spec.lutUsageMap);
+  getFfUsageMap(configObj, spec.ffUsageMap);
+  getAxiMap(configObj, spec.axiMap);
+  getDelayMap(configObj, spec.delayMap);
+  spec.clockPeriod = getClockPeriod(configObj);
+  return success();
+}
+
+/// Measure one iteration of the benchmark function, which may issue multiple
+/// calls to the benchmarked method, and accumulate into the result.
+template <typename FnT>
+static void measure(BenchResult &result, uint64_t numCalls, FnT fn) {
+  auto allocationsBegin = numAllocations.load(std::memory_order_relaxed);
+  auto timeBegin = std::chrono::steady_clock::now();
+  fn();
+  auto timeEnd = std::chrono::steady_clock::now();
+  result.numAllocations +=
+      numAllocations.load(std::memory_order_relaxed) - allocationsBegin;
+  result.microseconds +=
+      std::chrono::duration<double, std::micro>(timeEnd - timeBegin).count();
+  result.numCalls += numCalls;
+  result.peakRss = getPeakRss();
+}
+
+/// Run the benchmark function for the given number of iterations.
+template <typename FnT>
+static BenchResult runBenchmark(StringRef name, uint64_t numCalls, FnT fn) {
+  BenchResult result;
+  result.name = name.str();
+  for (unsigned i = 0; i < numIterations; ++i)
+    measure(result, numCalls, fn);
+  return result;
+}
+
+static void printResults(StringRef filename, ArrayRef<BenchResult> results) {
+  llvm::outs() << "== " << filename << "\n";
+  llvm::outs() << llvm::formatv("{0,-24} {1,8} {2,16} {3,12} {4,14}\n",
+                                "Benchmark", "Calls", "Time/Call (us)",
+                                "Allocs/Call", "Peak RSS (MB)");
+  for (auto &result : results) {
+    auto numCalls = std::max(result.numCalls, (uint64_t)1);
+    llvm::outs() << llvm::formatv(
+        "{0,-24} {1,8} {2,16:F2} {3,12:F1} {4,14:F1}\n", result.name,
+        result.numCalls, result.microseconds / numCalls,
+        (double)result.numAllocations / numCalls,
+        (double)result.peakRss / (1024 * 1024));
+  }
+  llvm::outs() << "\n";
+}
+
+static LogicalResult runBenchmarks(StringRef filename, MLIRContext &context,
+                                   TargetSpec &spec) {
+  auto module = parseSourceFile<ModuleOp>(filename, &context);
+  if (!module) {
+    llvm::errs() << "failed to parse " << filename << "\n";
+    return failure();
+  }
+
+  // Only top functions are estimated by the QoR estimation pass.
+  SmallVector<func::FuncOp, 4> topFuncs;
+  for (auto func : module->getOps<func::FuncOp>()) {
+    if (func.getName() == topFuncName)
+      hls::setTopFuncAttr(func);
+    if (hls::hasTopFuncAttr(func))
+      topFuncs.push_back(func);
+  }
+  if (topFuncs.empty()) {
+    llvm::errs() << "no top function is found in " << filename
+                 << ", specify one with -top-func\n";
+    return failure();
+  }
+
+  SmallVector<std::pair<AffineForOp, func::FuncOp>, 16> loops;
+  for (auto func : topFuncs)
+    for (auto loop : func.getOps<AffineForOp>())
+      loops.push_back({loop, func});
+
+  SmallVector<BenchResult, 8> results;
+
+  // A new estimator is created for each call, thus nothing is cached across
+  // calls, which is the case of estimating a new design point.
+  results.push_back(runBenchmark("estimateFunc (cold)", topFuncs.size(), [&] {
+    for (auto func : topFuncs) {
+      auto estimator = spec.createEstimator();
+      estimator.estimateFunc(func);
+    }
+  }));
+
+  // The same estimator is reused, thus loop schedules and dependences are
+  // cached across calls, which is the case of the DSE revisiting a function
+  // with few changes.
+  auto estimator = spec.createEstimator();
+  results.push_back(runBenchmark("estimateFunc (warm)", topFuncs.size(), [&] {
+    for (auto func : topFuncs)
+      estimator.estimateFunc(func);
+  }));
+
+  if (!loops.empty())
+    results.push_back(runBenchmark("estimateLoop", loops.size(), [&] {
+      auto estimator = spec.createEstimator();
+      for (auto &loopAndFunc : loops)
+        estimator.estimateLoop(loopAndFunc.first, loopAndFunc.second);
+    }));
+
+  // The pass is run on a clone of the module, such that each run starts from
+  // the same IR. Cloning is not included in the measured time.
+  PassManager pm(&context);
+  pm.addPass(createQoREstimationPass(targetSpec));
+  bool passFailed = false;
+  BenchResult passResult;
+  passResult.name = "qor-estimation pass";
+  for (unsigned i = 0; i < numIterations; ++i) {
+    auto clonedModule = OwningOpRef<ModuleOp>(module->clone());
+    measure(passResult, 1,
+            [&] { passFailed |= failed(pm.run(*clonedModule)); });
+  }
+  if (passFailed) {
+    llvm::errs() << "failed to run the QoR estimation pass on " << filename
+                 << "\n";
+    return failure();
+  }
+  results.push_back(passResult);
+
+  printResults(filename, results);
+  return success();
+}
+
+int main(int argc, char **argv) {
+  llvm::InitLLVM y(argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv,
+                                    "ScaleHLS Estimator Benchmark Tool\n");
+
+  TargetSpec spec;
+  if (failed(loadTargetSpec(targetSpec, spec)))
+    return 1;
+
+  DialectRegistry registry;
+  registerAllDialects(registry);
+  MLIRContext context(registry);
+  context.loadAllAvailableDialects();
+
+  for (auto &filename : inputFilenames)
+    if (failed(runBenchmarks(filename, context, spec)))
+      return 1;
+  return 0;
+}
@@ -7,11 +7,13 @@
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 #include "scalehls/InitAllDialects.h"
 #include "scalehls/InitAllPasses.h"
+#include "scalehls/Profile/Passes.h"
 
 int main(int argc, char **argv) {
   mlir::DialectRegistry registry;
   mlir::scalehls::registerAllDialects(registry);
   mlir::scalehls::registerAllPasses();
+  mlir::scalehls::registerProfilePasses();
 
   return mlir::failed(mlir::MlirOptMain(
       argc, argv, "ScaleHLS Optimization Tool", registry, true));
@@ -0,0 +1,26 @@
+# Parse each sample model into MLIR with Torch-MLIR, and profile the ScaleFlow
+# PyTorch pipeline on all of them. The JSON report is written to ${REPORT}.
+
+set(inputs)
+foreach(model lenet mobilenet resnet18 vgg16)
+  set(input ${WORK_DIR}/${model}.mlir)
+  execute_process(
+    COMMAND ${PYTHON} ${model}.py
+    WORKING_DIRECTORY ${SAMPLES_DIR}/${model}
+    OUTPUT_FILE ${input}
+    RESULT_VARIABLE result
+    )
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Failed to parse ${model} with Torch-MLIR")
+  endif()
+  list(APPEND inputs ${input})
+endforeach()
+
+execute_process(
+  COMMAND ${BENCH_TOOL} ${inputs} -o ${REPORT}
+  RESULT_VARIABLE result
+  )
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Failed to profile the ScaleFlow PyTorch pipeline")
+endif()
+message(STATUS "Pipeline profiles are written to ${REPORT}")
@@ -0,0 +1,248 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright 2020-2021 The ScaleHLS Authors.
+//
+//===----------------------------------------------------------------------===//
+//
+// This tool profiles the compile time and memory usage of a pass pipeline, by
+// default the ScaleFlow PyTorch pipeline, on each input MLIR file. The wall
+// time of each pass is collected with a pass instrumentation, along with the
+// number of operations in the IR and the peak resident set size of the process
+// after each pass of the outermost pipeline. A JSON report is written such that
+// the passes dominating the compilation of large models can be located.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassInstrumentation.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/FileUtilities.h"
+#include "scalehls/InitAllDialects.h"
+#include "scalehls/InitAllPasses.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include <chrono>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace mlir;
+using namespace scalehls;
+
+/// Return the peak resident set size of the process in bytes, or zero if it is
+/// not available on the host.
+static uint64_t getPeakRss() {
+#ifdef LLVM_ON_UNIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage))
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
+static double getMegabytes(uint64_t bytes) {
+  return (double)bytes / (1024 * 1024);
+}
+
+//===----------------------------------------------------------------------===//
+// Command Line Options
+//===----------------------------------------------------------------------===//
+
+static llvm::cl::list<std::string>
+    inputFilenames(llvm::cl::Positional, llvm::cl::OneOrMore,
+                   llvm::cl::desc("<input mlir files>"));
+
+static llvm::cl::opt<std::string> passPipeline(
+    "pass-pipeline",
+    llvm::cl::init("scaleflow-pytorch-pipeline{top-func=forward "
+                   "loop-tile-size=8 loop-unroll-factor=4}"),
+    llvm::cl::desc("The textual pass pipeline to be profiled"));
+
+static llvm::cl::opt<std::string>
+    outputFilename("o", llvm::cl::init("-"),
+                   llvm::cl::desc("Output filename of the JSON report"),
+                   llvm::cl::value_desc("filename"));
+
+static llvm::cl::opt<unsigned>
+    numTopPasses("top", llvm::cl::init(10),
+                 llvm::cl::desc("Number of the most time-consuming passes "
+                                "printed in the summary"));
+
+//===----------------------------------------------------------------------===//
+// Pipeline Profiler
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// The profile of a pass run on the root operation of the pipeline.
+struct PassProfile {
+  std::string name;
+  double seconds = 0;
+  int64_t numOps = 0;
+  uint64_t peakRss = 0;
+};
+
+/// The accumulated time of all runs of a pass, including the runs nested in
+/// the pipelines on functions or other operations.
+struct PassTotal {
+  double seconds = 0;
+  unsigned numRuns = 0;
+};
+
+/// Collect the profiles of passes. The pass manager must not be multi-threaded,
+/// because the runs of passes are tracked with a stack.
+class PipelineProfiler : public PassInstrumentation {
+public:
+  explicit PipelineProfiler(Operation *root) : root(root) {}
+
+  void runBeforePass(Pass *pass, Operation *op) override {
+    timeStack.push_back(std::chrono::steady_clock::now());
+  }
+  void runAfterPass(Pass *pass, Operation *op) override { profile(pass, op); }
+  void runAfterPassFailed(Pass *pass, Operation *op) override {
+    profile(pass, op);
+  }
+
+  SmallVector<PassProfile, 64> profiles;
+  llvm::MapVector<StringRef, PassTotal> totals;
+
+private:
+  void profile(Pass *pass, Operation *op) {
+    auto timeBegin = timeStack.pop_back_val();
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - timeBegin)
+                       .count();
+
+    // Pass adaptors running nested pipelines don't have an argument, whose
+    // nested passes are accumulated separately.
+    auto argument = pass->getArgument();
+    if (!argument.empty()) {
+      auto &total = totals[argument];
+      total.seconds += seconds;
+      ++total.numRuns;
+    }
+    if (op != root)
+      return;
+
+    PassProfile profile;
+    profile.name = argument.empty() ? pass->getName().str() : argument.str();
+    profile.seconds = seconds;
+    root->walk([&](Operation *) { ++profile.numOps; });
+    profile.peakRss = getPeakRss();
+    profiles.push_back(profile);
+  }
+
+  Operation *root;
+  SmallVector<std::chrono::steady_clock::time_point, 8> timeStack;
+};
+} // namespace
+
+static Optional<llvm::json::Value>
+profilePipeline(StringRef filename, MLIRContext &context) {
+  auto module = parseSourceFile<ModuleOp>(filename, &context);
+  if (!module) {
+    llvm::errs() << "failed to parse " << filename << "\n";
+    return llvm::None;
+  }
+
+  PassManager pm(&context);
+  if (failed(parsePassPipeline(passPipeline, pm, llvm::errs())))
+    return llvm::None;
+  auto profiler = std::make_unique<PipelineProfiler>(*module);
+  auto &profilerRef = *profiler;
+  pm.addInstrumentation(std::move(profiler));
+
+  auto timeBegin = std::chrono::steady_clock::now();
+  auto result = pm.run(*module);
+  auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - timeBegin)
+                     .count();
+  if (failed(result)) {
+    llvm::errs() << "failed to run the pipeline on " << filename << "\n";
+    return llvm::None;
+  }
+
+  // Print a summary of the most time-consuming passes.
+  auto totals = SmallVector<std::pair<StringRef, PassTotal>, 64>(
+      profilerRef.totals.begin(), profilerRef.totals.end());
+  llvm::stable_sort(totals, [](auto &a, auto &b) {
+    return a.second.seconds > b.second.seconds;
+  });
+  llvm::errs() << llvm::formatv("== {0}: {1:F2}s, peak RSS {2:F1} MB\n",
+                                filename, seconds,
+                                getMegabytes(getPeakRss()));
+  for (auto &total : llvm::make_range(
+           totals.begin(),
+           totals.begin() + std::min((size_t)numTopPasses, totals.size())))
+    llvm::errs() << llvm::formatv("{0,10:F3}s {1,6:P} {2}\n",
+                                  total.second.seconds,
+                                  total.second.seconds / seconds, total.first);
+
+  llvm::json::Array passesReport;
+  for (auto &profile : profilerRef.profiles)
+    passesReport.push_back(
+        llvm::json::Object{{"pass", profile.name},
+                           {"seconds", profile.seconds},
+                           {"num_ops", profile.numOps},
+                           {"peak_rss_mb", getMegabytes(profile.peakRss)}});
+
+  llvm::json::Array totalsReport;
+  for (auto &total : totals)
+    totalsReport.push_back(
+        llvm::json::Object{{"pass", total.first},
+                           {"seconds", total.second.seconds},
+                           {"num_runs", total.second.numRuns}});
+
+  return llvm::json::Value(
+      llvm::json::Object{{"input", filename},
+                         {"pipeline", passPipeline.getValue()},
+                         {"seconds", seconds},
+                         {"peak_rss_mb", getMegabytes(getPeakRss())},
+                         {"passes", std::move(passesReport)},
+                         {"pass_totals", std::move(totalsReport)}});
+}
+
+int main(int argc, char **argv) {
+  llvm::InitLLVM y(argc, argv);
+  registerAllPasses();
+  llvm::cl::ParseCommandLineOptions(argc, argv,
+                                    "ScaleHLS Pipeline Benchmark Tool\n");
+
+  // Passes are profiled in a single thread.
+  DialectRegistry registry;
+  registerAllDialects(registry);
+  MLIRContext context(registry);
+  context.disableMultithreading();
+
+  llvm::json::Array report;
+  for (auto &filename : inputFilenames) {
+    auto inputReport = profilePipeline(filename, context);
+    if (!inputReport)
+      return 1;
+    report.push_back(std::move(*inputReport));
+  }
+
+  std::string errorMessage;
+  auto output = openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return 1;
+  }
+  output->os() << llvm::formatv("{0:2}", llvm::json::Value(std::move(report)))
+               << "\n";
+  output->keep();
+  return 0;
+}
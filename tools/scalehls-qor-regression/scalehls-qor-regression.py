@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+
+# Check the quality of results (QoR) of ScaleHLS over the bundled samples. Each
+# kernel is parsed by its front-end, compiled with the DSE or ScaleFlow
+# pipeline, and estimated with the QoR estimation pass. The estimated latency,
+# DSP and BRAM utilization, and the compile time of the pipeline are compared
+# against a baseline file, and the check fails if any kernel regresses beyond
+# the thresholds. The random seed of the DSE is fixed, such that the results
+# are reproducible. Run with "--update" to record a new baseline.
+
+
+import argparse
+import json
+import os
+import sys
+import tempfile
+import time
+from subprocess import PIPE, run
+
+
+# The random seed of the DSE, which overrides the one in the target spec.
+RANDOM_SEED = 1
+
+# Kernels of the suite, where the paths are relative to the samples directory.
+# C/C++ kernels are parsed by "cgeist" and compiled with the DSE pipeline,
+# while PyTorch models are parsed by Torch-MLIR and compiled with the ScaleFlow
+# pipeline.
+KERNELS = [
+    {'name': 'polybench/bicg', 'source': 'polybench/bicg/test_bicg.c',
+     'top_func': 'test_bicg', 'config': 'polybench/config.json'},
+    {'name': 'polybench/gemm', 'source': 'polybench/gemm/test_gemm.c',
+     'top_func': 'test_gemm', 'config': 'polybench/config.json'},
+    {'name': 'polybench/gesummv',
+     'source': 'polybench/gesummv/test_gesummv.c',
+     'top_func': 'test_gesummv', 'config': 'polybench/config.json'},
+    {'name': 'polybench/syr2k', 'source': 'polybench/syr2k/test_syr2k.c',
+     'top_func': 'test_syr2k', 'config': 'polybench/config.json'},
+    {'name': 'polybench/syrk', 'source': 'polybench/syrk/test_syrk.c',
+     'top_func': 'test_syrk', 'config': 'polybench/config.json'},
+    {'name': 'polybench/trmm', 'source': 'polybench/trmm/test_trmm.c',
+     'top_func': 'test_trmm', 'config': 'polybench/config.json'},
+    {'name': 'rosetta/digit-recognition',
+     'source': 'rosetta/digit-recognition/digitrec_sw.c',
+     'top_func': 'DigitRec_sw', 'config': 'rosetta/config.json'},
+    {'name': 'rosetta/spam-filter', 'source': 'rosetta/spam-filter/sgd_sw.c',
+     'top_func': 'SgdLR_sw', 'config': 'rosetta/config.json'},
+    {'name': 'machsuite/backprop', 'source': 'machsuite/backprop/backprop.c',
+     'top_func': 'backprop', 'config': 'polybench/config.json',
+     'cgeist_flags': ['-O0', '-subindex-to-subview'],
+     'preprocess': ['-scalehls-materialize-reduction',
+                    '-scalehls-func-duplication',
+                    '-scalehls-func-preprocess=top-func=backprop',
+                    '-buffer-loop-hoisting', '-affine-scalrep',
+                    '-fold-memref-subview-ops',
+                    '-affine-simplify-structures', '-canonicalize',
+                    '-scalehls-affine-loop-perfection']},
+    {'name': 'pytorch/lenet', 'source': 'pytorch/lenet/lenet.py',
+     'top_func': 'forward', 'config': 'polybench/config.json'},
+    {'name': 'pytorch/mobilenet', 'source': 'pytorch/mobilenet/mobilenet.py',
+     'top_func': 'forward', 'config': 'polybench/config.json'},
+    {'name': 'pytorch/resnet18', 'source': 'pytorch/resnet18/resnet18.py',
+     'top_func': 'forward', 'config': 'polybench/config.json'},
+    {'name': 'pytorch/vgg16', 'source': 'pytorch/vgg16/vgg16.py',
+     'top_func': 'forward', 'config': 'polybench/config.json'},
+]
+
+# The QoR metrics compared against the baseline, all of which are better if
+# smaller.
+QOR_METRICS = ['latency', 'dsp', 'bram']
+
+
+class KernelError(Exception):
+    pass
+
+
+class KernelSkipped(Exception):
+    pass
+
+
+def do_run(command, cwd=None, stdin=None):
+    ret = run(command, input=stdin, stdout=PIPE, stderr=PIPE,
+              universal_newlines=True, cwd=cwd)
+    if ret.returncode != 0:
+        raise KernelError('"{}" failed:\n{}'.format(
+            ' '.join(command), ret.stderr.strip()))
+    return ret.stdout
+
+
+def parse_source(kernel, source, opts):
+    try:
+        if source.endswith('.py'):
+            return do_run([opts.python, source], cwd=os.path.dirname(source))
+        mlir = do_run([opts.cgeist, '-S', '-function=' + kernel['top_func'],
+                       '-memref-fullrank', '-raise-scf-to-affine'] +
+                      kernel.get('cgeist_flags', []) + [source])
+    except FileNotFoundError as e:
+        raise KernelSkipped('front-end is not found: {}'.format(e.filename))
+    except KernelError as e:
+        if 'ModuleNotFoundError' in str(e):
+            raise KernelSkipped('Torch-MLIR is not installed')
+        raise
+    if 'preprocess' in kernel:
+        mlir = do_run([opts.opt] + kernel['preprocess'], stdin=mlir)
+    return mlir
+
+
+def get_pipeline(kernel, source, config_path):
+    if source.endswith('.py'):
+        return ('-scaleflow-pytorch-pipeline=top-func={} loop-tile-size=8 '
+                'loop-unroll-factor=4'.format(kernel['top_func']))
+    return '-scalehls-dse-pipeline=top-func={} target-spec={}'.format(
+        kernel['top_func'], config_path)
+
+
+def run_kernel(kernel, opts, work_dir):
+    source = os.path.abspath(os.path.join(opts.samples, kernel['source']))
+    mlir = parse_source(kernel, source, opts)
+
+    # Fix the random seed of the DSE.
+    with open(os.path.join(opts.samples, kernel['config']), 'r') as f:
+        config = json.load(f)
+    config['random_seed'] = RANDOM_SEED
+    config_path = os.path.join(work_dir, 'config.json')
+    with open(config_path, 'w') as f:
+        json.dump(config, f, indent=4)
+
+    # The DSE dumps design points into the working directory.
+    begin = time.perf_counter()
+    mlir = do_run([opts.opt, get_pipeline(kernel, source, config_path)],
+                  cwd=work_dir, stdin=mlir)
+    compile_time = time.perf_counter() - begin
+
+    report_path = os.path.join(work_dir, 'report.json')
+    do_run([opts.opt, '-scalehls-qor-estimation=target-spec={} '
+            'report-json={}'.format(config_path, report_path)],
+           stdin=mlir)
+    with open(report_path, 'r') as f:
+        report = json.load(f)
+
+    funcs = [func for func in report if func['name'] == kernel['top_func']]
+    if not funcs:
+        funcs = report
+    if not funcs:
+        raise KernelError('no function is estimated')
+    return {'latency': funcs[0]['latency'], 'dsp': funcs[0]['dsp'],
+            'bram': funcs[0]['bram'], 'compile_time': compile_time}
+
+
+def is_regressed(value, baseline_value, threshold, slack=0):
+    if value is None or baseline_value is None:
+        return False
+    return value > baseline_value * (1 + threshold) + slack
+
+
+def compare(name, result, baseline, opts):
+    """Return the descriptions of all regressions of the kernel."""
+    if name not in baseline:
+        return []
+
+    regressions = []
+    for metric in QOR_METRICS:
+        if is_regressed(result[metric], baseline[name].get(metric),
+                        opts.qor_threshold):
+            regressions.append('{} {} -> {}'.format(
+                metric, baseline[name][metric], result[metric]))
+    if is_regressed(result['compile_time'],
+                    baseline[name].get('compile_time'), opts.time_threshold,
+                    opts.time_slack):
+        regressions.append('compile time {:.2f}s -> {:.2f}s'.format(
+            baseline[name]['compile_time'], result['compile_time']))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(prog='scalehls-qor-regression')
+    parser.add_argument('-b', dest='baseline',
+                        metavar='baseline',
+                        required=True,
+                        help='Baseline file of QoR and compile time')
+    parser.add_argument('-s', dest='samples',
+                        metavar='samples',
+                        required=True,
+                        help='Directory of the bundled samples')
+    parser.add_argument('-k', dest='kernels',
+                        metavar='kernel',
+                        nargs='+',
+                        help='Only run the given kernels, such as '
+                        'polybench/gemm')
+    parser.add_argument('--update', dest='update',
+                        action='store_true',
+                        help='Record the results as the new baseline')
+    parser.add_argument('--skip-missing-baseline', dest='skip_missing',
+                        action='store_true',
+                        help='Skip the check rather than fail if the '
+                        'baseline is not found')
+    parser.add_argument('--qor-threshold', dest='qor_threshold',
+                        type=float, default=0.05,
+                        help='Tolerated relative increase of QoR metrics')
+    parser.add_argument('--time-threshold', dest='time_threshold',
+                        type=float, default=0.5,
+                        help='Tolerated relative increase of compile time')
+    parser.add_argument('--time-slack', dest='time_slack',
+                        type=float, default=1.0,
+                        help='Tolerated absolute increase of compile time in '
+                        'seconds, which absorbs the noise of short runs')
+    parser.add_argument('--scalehls-opt', dest='opt',
+                        default='scalehls-opt',
+                        help='Path to scalehls-opt')
+    parser.add_argument('--cgeist', dest='cgeist',
+                        default='cgeist',
+                        help='Path to cgeist')
+    parser.add_argument('--python', dest='python',
+                        default=sys.executable,
+                        help='Python interpreter with Torch-MLIR installed')
+
+    # Parse command line arguments.
+    opts = parser.parse_args()
+
+    baseline = {}
+    if os.path.exists(opts.baseline):
+        with open(opts.baseline, 'r') as f:
+            baseline = json.load(f)
+    elif not opts.update:
+        # The baseline depends on the front-ends and the target spec, thus it
+        # may not be recorded in a fresh checkout.
+        print('baseline {} is not found, run with --update to record '
+              'it'.format(opts.baseline), file=sys.stderr)
+        if opts.skip_missing:
+            print('QoR regression check is SKIPPED')
+            sys.exit(0)
+        sys.exit(1)
+
+    kernels = [kernel for kernel in KERNELS
+               if not opts.kernels or kernel['name'] in opts.kernels]
+
+    # Kernels that fail to compile are reported as failures, unless their
+    # front-ends are not available.
+    results = {}
+    failures = []
+    for kernel in kernels:
+        name = kernel['name']
+        with tempfile.TemporaryDirectory() as work_dir:
+            try:
+                results[name] = run_kernel(kernel, opts, work_dir)
+            except KernelSkipped as e:
+                print('{:<28} {:<10} {}'.format(name, 'SKIPPED', e))
+                continue
+            except (KernelError, OSError) as e:
+                failures.append('{}: {}'.format(name, e))
+                continue
+
+        result = results[name]
+        regressions = compare(name, result, baseline, opts)
+        status = 'REGRESSED' if regressions else (
+            'NEW' if name not in baseline else 'OK')
+        print('{:<28} {:<10} latency={} dsp={} bram={} time={:.2f}s'.format(
+            name, status, result['latency'], result['dsp'], result['bram'],
+            result['compile_time']))
+        for regression in regressions:
+            failures.append('{}: {}'.format(name, regression))
+
+    if opts.update:
+        baseline.update(results)
+        with open(opts.baseline, 'w') as f:
+            json.dump(baseline, f, indent=4, sort_keys=True)
+            f.write('\n')
+        print('baseline of {} kernels is written to {}'.format(
+            len(results), opts.baseline))
+
+    for failure in failures:
+        print('error: ' + failure, file=sys.stderr)
+    if failures and not opts.update:
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()